@@ -18,8 +18,12 @@
 #define DATAMANAGEMENT_DATAMANAGEMENT_HPP_
 
 #include <datamanagement/modeldata/model_data.hpp>
+#include <datamanagement/source/column_table.hpp>
 #include <datamanagement/source/config.hpp>
 #include <datamanagement/source/csv_source.hpp>
 #include <datamanagement/source/db_source.hpp>
+#include <datamanagement/source/predicate.hpp>
+#include <datamanagement/source/sidecar.hpp>
+#include <datamanagement/source/stratified_table.hpp>
 
 #endif // DATAMANAGEMENT_DATAMANAGEMENT_HPP_
\ No newline at end of file
@@ -4,7 +4,7 @@
 // Created Date: Th Feb 2025                                                  //
 // Author: Matthew Carroll                                                    //
 // -----                                                                      //
-// Last Modified: Thu Feb 20 2025                                             //
+// Last Modified: Sat Oct 17 2026                                             //
 // Modified By: Matthew Carroll                                               //
 // -----                                                                      //
 // Copyright (c) 2025 Syndemics Lab at Boston Medical Center                  //
@@ -17,14 +17,18 @@
 #ifndef DATAMANAGEMENT_MODELDATA_MODELDATA_HPP_
 #define DATAMANAGEMENT_MODELDATA_MODELDATA_HPP_
 
+#include <algorithm>
 #include <filesystem>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <datamanagement/source/config.hpp>
 #include <datamanagement/source/csv_source.hpp>
 #include <datamanagement/source/db_source.hpp>
+#include <datamanagement/utils/thread_pool.hpp>
 
 namespace datamanagement {
 class ModelData {
@@ -34,18 +38,40 @@ private:
         _csv_sources = {};
     std::unordered_map<std::string, datamanagement::source::DBSource>
         _db_sources = {};
+    std::unique_ptr<datamanagement::utils::ThreadPool> _prefetch_pool =
+        nullptr;
 
 public:
     ModelData(const std::string &cfgfile) : config(cfgfile) {}
     ~ModelData() = default;
     datamanagement::source::Config GetConfig() const { return config; }
 
+    // With prefetching on, AddSource starts parsing and caching each csv on
+    // a background pool of threads workers (see CSVSource::Prefetch), so
+    // the work overlaps with the rest of model setup. Turning it off waits
+    // for the builds already started.
+    void SetPrefetch(bool enable,
+                     size_t threads = std::thread::hardware_concurrency()) {
+        threads = std::max<size_t>(threads, 1);
+        if (!enable) {
+            _prefetch_pool.reset();
+        } else if (!_prefetch_pool || _prefetch_pool->Size() != threads) {
+            _prefetch_pool =
+                std::make_unique<datamanagement::utils::ThreadPool>(threads);
+        }
+    }
+
+    bool IsPrefetching() const { return _prefetch_pool != nullptr; }
+
     void AddSource(const std::string &path) {
         std::filesystem::path p = path;
         if (p.extension() == ".csv") {
             datamanagement::source::CSVSource s;
             _csv_sources[p.stem()] = std::move(s);
             _csv_sources[p.stem()].ConnectToFile(path);
+            if (_prefetch_pool) {
+                _csv_sources[p.stem()].Prefetch(*_prefetch_pool);
+            }
         } else if (p.extension() == ".db") {
             datamanagement::source::DBSource s;
             _db_sources[p.stem()] = std::move(s);
@@ -77,6 +103,24 @@ public:
     datamanagement::source::DBSource &GetDBSource(const std::string &name) {
         return _db_sources[name];
     }
+
+    // Joins two registered csv sources on the key columns they share (see
+    // CSVSource::Join). Rows hold left_select from left followed by
+    // right_select from right, for every pair of rows with equal keys.
+    Eigen::MatrixXd
+    JoinCSVSources(const std::string &left, const std::string &right,
+                   const std::vector<std::string> &key_columns,
+                   const std::vector<std::string> &left_select,
+                   const std::vector<std::string> &right_select) {
+        auto l = _csv_sources.find(left);
+        auto r = _csv_sources.find(right);
+        if (l == _csv_sources.end() || r == _csv_sources.end()) {
+            throw std::runtime_error("Can't find a csv source named " +
+                                     (l == _csv_sources.end() ? left : right));
+        }
+        return l->second.Join(r->second, key_columns, left_select,
+                              right_select);
+    }
 };
 } // namespace datamanagement
 
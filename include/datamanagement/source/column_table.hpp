@@ -0,0 +1,1065 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: column_table.hpp                                                     //
+// Project: source                                                            //
+// Created Date: Sa Oct 2026                                                  //
+// Author: Matthew Carroll                                                    //
+// -----                                                                      //
+// Last Modified: Sat Oct 17 2026                                             //
+// Modified By: Matthew Carroll                                               //
+// -----                                                                      //
+// Copyright (c) 2026 Syndemics Lab at Boston Medical Center                  //
+// -----                                                                      //
+// HISTORY:                                                                   //
+// Date      	By	Comments                                                  //
+// ----------	---	--------------------------------------------------------- //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATAMANAGEMENT_SOURCE_COLUMNTABLE_HPP_
+#define DATAMANAGEMENT_SOURCE_COLUMNTABLE_HPP_
+
+#include <Eigen/Core>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <datamanagement/source/predicate.hpp>
+#include <datamanagement/source/stratified_table.hpp>
+#include <datamanagement/utils/convert.hpp>
+#include <datamanagement/utils/csv.hpp>
+#include <datamanagement/utils/thread_pool.hpp>
+#include <filesystem>
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace datamanagement::source {
+// The values of a numeric column. They are either owned or a view into
+// memory the owning table keeps alive, such as a mapped sidecar file.
+class NumericColumn {
+private:
+    std::vector<double> owned = {};
+    const double *view = nullptr;
+    size_t view_size = 0;
+
+public:
+    NumericColumn() {}
+    NumericColumn(const double *data, size_t size)
+        : view(data), view_size(size) {}
+
+    size_t Size() const { return view ? view_size : owned.size(); }
+    const double *Data() const { return view ? view : owned.data(); }
+    double operator[](size_t row) const { return Data()[row]; }
+
+    void Add(double value) { owned.push_back(value); }
+
+    void Clear() {
+        owned = {};
+        view = nullptr;
+        view_size = 0;
+    }
+};
+
+// The text of every row of a column packed into one buffer, row r spanning
+// bytes [offsets[r], offsets[r + 1]). This keeps millions of short strings
+// out of the allocator. Like NumericColumn it is either owned or a view.
+class TextColumn {
+private:
+    std::vector<uint64_t> owned_offsets = {0};
+    std::string owned_bytes = "";
+    const uint64_t *offsets = owned_offsets.data();
+    const char *bytes = owned_bytes.data();
+    size_t rows = 0;
+
+    // Owned columns point into their own buffers, views have none
+    void Repoint() {
+        if (!owned_offsets.empty()) {
+            offsets = owned_offsets.data();
+            bytes = owned_bytes.data();
+        }
+    }
+
+public:
+    TextColumn() {}
+    // offsets holds rows + 1 entries into bytes.
+    TextColumn(const uint64_t *offsets, const char *bytes, size_t rows)
+        : owned_offsets(), offsets(offsets), bytes(bytes), rows(rows) {}
+    TextColumn(const TextColumn &other) { *this = other; }
+    TextColumn &operator=(const TextColumn &other) {
+        owned_offsets = other.owned_offsets;
+        owned_bytes = other.owned_bytes;
+        offsets = other.offsets;
+        bytes = other.bytes;
+        rows = other.rows;
+        Repoint();
+        return *this;
+    }
+    TextColumn(TextColumn &&other) noexcept { *this = std::move(other); }
+    TextColumn &operator=(TextColumn &&other) noexcept {
+        owned_offsets = std::move(other.owned_offsets);
+        owned_bytes = std::move(other.owned_bytes);
+        offsets = other.offsets;
+        bytes = other.bytes;
+        rows = other.rows;
+        Repoint();
+        other.owned_offsets = {0};
+        other.owned_bytes.clear();
+        other.rows = 0;
+        other.Repoint();
+        return *this;
+    }
+    ~TextColumn() = default;
+
+    size_t Size() const { return rows; }
+    const uint64_t *Offsets() const { return offsets; }
+    const char *Bytes() const { return bytes; }
+
+    void Add(csv::string_view text) {
+        owned_bytes.append(text.data(), text.size());
+        owned_offsets.push_back(owned_bytes.size());
+        Repoint();
+        ++rows;
+    }
+
+    void Clear() {
+        owned_offsets = {0};
+        owned_bytes.clear();
+        rows = 0;
+        Repoint();
+    }
+
+    csv::string_view operator[](size_t row) const {
+        return csv::string_view(bytes + offsets[row],
+                                offsets[row + 1] - offsets[row]);
+    }
+};
+
+// Dense integer codes for the values of a text column. Code c stands for
+// values[c]; codes are given in order of first appearance.
+struct Dictionary {
+    std::vector<uint32_t> codes = {};
+    std::vector<std::string> values = {};
+    std::unordered_map<std::string, uint32_t> lookup = {};
+};
+
+struct Column {
+    std::string name;
+    // A column stays numeric until a field fails to parse as a number, at
+    // which point it falls back to holding the raw text of every row.
+    bool numeric = true;
+    NumericColumn values = {};
+    // A numeric column also keeps its raw text once some field is not the
+    // shortest spelling of its number (such as "35.0" or "007"), so that
+    // text comparisons see what the file holds. It stays empty otherwise.
+    TextColumn text = {};
+    // Set on text columns declared categorical, which then read as their
+    // codes wherever a number is needed.
+    std::shared_ptr<const Dictionary> dictionary = nullptr;
+};
+
+enum class Aggregation { SUM, MEAN, MIN, MAX, COUNT };
+
+// The result of ColumnTable::Aggregate. Group g has the key values keys[g]
+// (one per group column, as text) and the aggregates values.row(g) (one per
+// value column). Groups are in order of first appearance.
+struct GroupedData {
+    std::vector<std::string> group_columns = {};
+    std::vector<std::vector<std::string>> keys = {};
+    Eigen::MatrixXd values = {};
+};
+
+class ColumnTable {
+private:
+    std::vector<Column> columns = {};
+    std::unordered_map<std::string, size_t> column_index = {};
+    size_t rows = 0;
+    uintmax_t file_size = 0;
+    std::filesystem::file_time_type modified_time = {};
+    // Keeps alive the memory that view columns point into
+    std::shared_ptr<const void> storage = nullptr;
+
+    // Rows holding each distinct value of an indexed column. Numeric columns
+    // are keyed by value, text columns by their raw text.
+    struct ColumnIndex {
+        std::unordered_map<double, std::vector<size_t>> numbers = {};
+        std::unordered_map<std::string, std::vector<size_t>> text = {};
+    };
+    std::unordered_map<size_t, ColumnIndex> indexes = {};
+
+    int Resolve(const std::string &name) const {
+        int index = IndexOf(name);
+        if (index == csv::CSV_NOT_FOUND) {
+            throw std::runtime_error("Can't find a column named " + name);
+        }
+        return index;
+    }
+
+    // Throws one error naming every column of select_columns and where that
+    // the table lacks, like the csv scan does, before any work is done.
+    void CheckColumns(const std::vector<std::string> &select_columns,
+                      const Predicate &where) const {
+        std::vector<std::string> missing;
+        auto check = [&](const std::string &name) {
+            if (IndexOf(name) == csv::CSV_NOT_FOUND &&
+                std::find(missing.begin(), missing.end(), name) ==
+                    missing.end()) {
+                missing.push_back(name);
+            }
+        };
+        for (const std::string &name : select_columns) {
+            check(name);
+        }
+        for (const std::string &name : where.GetColumns()) {
+            check(name);
+        }
+        if (!missing.empty()) {
+            std::string message = "Can't find columns named:";
+            for (const std::string &name : missing) {
+                message += " " + name;
+            }
+            throw std::runtime_error(message);
+        }
+    }
+
+    // Fills out with the rows an equality or In predicate can match, taken
+    // from the index on its column. Returns false when there is no index
+    // able to answer it.
+    bool Lookup(const Predicate &leaf, std::vector<size_t> &out) const {
+        using Op = Predicate::Op;
+        Op op = leaf.GetOp();
+        if (op != Op::EQUAL && op != Op::IN && op != Op::TEXT_EQUAL &&
+            op != Op::TEXT_IN) {
+            return false;
+        }
+        auto found = indexes.find(Resolve(leaf.GetColumn()));
+        if (found == indexes.end()) {
+            return false;
+        }
+        const ColumnIndex &index = found->second;
+        bool numeric = columns[found->first].numeric;
+
+        std::vector<double> numbers;
+        if (op == Op::EQUAL) {
+            numbers.push_back(leaf.GetLow());
+        } else if (op == Op::IN) {
+            numbers = leaf.GetNumbers();
+        } else if (numeric) {
+            for (const std::string &value : leaf.GetStrings()) {
+                numbers.push_back(ToNumber(value));
+            }
+        }
+        if (!numeric && !numbers.empty()) {
+            // Matching numbers against text needs every row parsed
+            return false;
+        }
+
+        out.clear();
+        size_t lists = 0;
+        auto append = [&out, &lists](const std::vector<size_t> &rows) {
+            out.insert(out.end(), rows.begin(), rows.end());
+            ++lists;
+        };
+        for (double value : numbers) {
+            auto it = index.numbers.find(value);
+            if (it != index.numbers.end()) {
+                append(it->second);
+            }
+        }
+        if (!numeric) {
+            for (const std::string &value : leaf.GetStrings()) {
+                auto it = index.text.find(value);
+                if (it != index.text.end()) {
+                    append(it->second);
+                }
+            }
+        }
+        if (lists > 1) {
+            std::sort(out.begin(), out.end());
+            out.erase(std::unique(out.begin(), out.end()), out.end());
+        }
+        return true;
+    }
+
+    static double ParseDouble(csv::string_view text) {
+        return csv::CSVField(text).get<double>();
+    }
+
+    static double Value(const Column &column, size_t row) {
+        if (column.numeric) {
+            return column.values[row];
+        }
+        return column.dictionary ? column.dictionary->codes[row]
+                                 : ParseDouble(column.text[row]);
+    }
+
+    // Shortest text that reads back as value, so 3.0 prints as 3.
+    static std::string FormatNumber(double value) {
+        char buffer[32];
+        auto [end, error] =
+            std::to_chars(buffer, buffer + sizeof(buffer), value);
+        return std::string(buffer, end);
+    }
+
+    // Whether text is the one spelling of value that keeps no raw text: the
+    // shortest fixed notation that reads back as value. Plain integers
+    // without a sign or leading zeros are checked without formatting.
+    static bool IsCanonical(csv::string_view text, double value) {
+        if (!text.empty() && text.size() < 16 &&
+            (text[0] != '0' || text.size() == 1)) {
+            bool digits = true;
+            for (char c : text) {
+                digits = digits && c >= '0' && c <= '9';
+            }
+            if (digits) {
+                return true;
+            }
+        }
+        char buffer[400];
+        auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer),
+                                          value, std::chars_format::fixed);
+        return error == std::errc() &&
+               text == csv::string_view(buffer, end - buffer);
+    }
+
+    // Marks a row whose key has no code, such as a non-number in a numeric
+    // join key.
+    static constexpr uint64_t MISSING_CODE =
+        std::numeric_limits<uint64_t>::max();
+
+    // Dense codes of column at rows, numbered in order of first appearance:
+    // numeric columns by value, text columns by their text. Returns the
+    // number of distinct values. first, when given, receives for each code
+    // the position in rows where it first appears.
+    static uint64_t DenseCodes(const Column &column,
+                               const std::vector<size_t> &rows,
+                               std::vector<uint64_t> &codes,
+                               std::vector<size_t> *first = nullptr) {
+        codes.resize(rows.size());
+        auto number = [&](auto &map, const auto &key, size_t i) {
+            auto [it, added] = map.try_emplace(key, map.size());
+            if (added && first) {
+                first->push_back(i);
+            }
+            codes[i] = it->second;
+        };
+        if (column.numeric) {
+            std::unordered_map<double, uint64_t> map;
+            for (size_t i = 0; i < rows.size(); ++i) {
+                number(map, column.values[rows[i]], i);
+            }
+            return map.size();
+        }
+        std::unordered_map<csv::string_view, uint64_t> map;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            number(map, column.text[rows[i]], i);
+        }
+        return map.size();
+    }
+
+    // Folds the codes of one more key column into the ids of the same rows.
+    // Each (id, code) pair gets a new id in order of first appearance,
+    // recorded in combine, so ids never outgrow the row count. A missing id
+    // or code gives a missing id.
+    static void CombineCodes(std::vector<uint64_t> &ids,
+                             const std::vector<uint64_t> &codes,
+                             uint64_t distinct,
+                             std::unordered_map<uint64_t, uint64_t> &combine) {
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (ids[i] == MISSING_CODE || codes[i] == MISSING_CODE) {
+                ids[i] = MISSING_CODE;
+                continue;
+            }
+            ids[i] = combine.try_emplace(ids[i] * distinct + codes[i],
+                                         combine.size())
+                         .first->second;
+        }
+    }
+
+    static bool TryParseDouble(csv::CSVField &field, double &out) {
+        if (csv::internals::try_parse_double(field.get_sv(), out)) {
+            return true;
+        }
+        if (!field.is_num()) {
+            return false;
+        }
+        out = field.get<double>();
+        return true;
+    }
+
+public:
+    ColumnTable() {}
+    // storage owns whatever memory the columns' views point into.
+    ColumnTable(std::vector<Column> columns, size_t rows, uintmax_t file_size,
+                std::filesystem::file_time_type modified_time,
+                std::shared_ptr<const void> storage = nullptr)
+        : columns(std::move(columns)), rows(rows), file_size(file_size),
+          modified_time(modified_time), storage(std::move(storage)) {
+        for (size_t i = 0; i < this->columns.size(); ++i) {
+            column_index[this->columns[i].name] = i;
+        }
+    }
+
+    static ColumnTable Load(const std::string &path) {
+        ColumnTable table;
+        Load(path, table);
+        return table;
+    }
+
+    // Parses path into table, which must be empty, so callers can fill a
+    // table they already allocated.
+    static void Load(const std::string &path, ColumnTable &table) {
+        table.file_size = std::filesystem::file_size(path);
+        table.modified_time = std::filesystem::last_write_time(path);
+
+        csv::CSVReader reader(path);
+        for (const std::string &name : reader.get_col_names()) {
+            table.column_index[name] = table.columns.size();
+            table.columns.push_back({name});
+        }
+
+        // raw[i] is set once column i keeps its raw text. Until then every
+        // field was the canonical spelling of its number, so the text of
+        // the rows before can be rebuilt from the values.
+        std::vector<bool> raw(table.columns.size(), false);
+        for (csv::CSVRow &row : reader) {
+            for (size_t i = 0; i < table.columns.size(); ++i) {
+                Column &column = table.columns[i];
+                csv::CSVField field = row[i];
+                if (!column.numeric) {
+                    column.text.Add(field.get_sv());
+                    continue;
+                }
+                double value = 0;
+                bool parsed = TryParseDouble(field, value);
+                if (!raw[i] &&
+                    !(parsed && IsCanonical(field.get_sv(), value))) {
+                    char buffer[400];
+                    for (size_t r = 0; r < table.rows; ++r) {
+                        auto [end, error] = std::to_chars(
+                            buffer, buffer + sizeof(buffer),
+                            column.values[r], std::chars_format::fixed);
+                        column.text.Add(
+                            csv::string_view(buffer, end - buffer));
+                    }
+                    raw[i] = true;
+                }
+                if (raw[i]) {
+                    column.text.Add(field.get_sv());
+                }
+                if (parsed) {
+                    column.values.Add(value);
+                } else {
+                    column.numeric = false;
+                    column.values.Clear();
+                }
+            }
+            ++table.rows;
+        }
+    }
+
+    bool IsStale(const std::string &path) const {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return true;
+        }
+        return size != file_size ||
+               std::filesystem::last_write_time(path, ec) != modified_time;
+    }
+
+    // Builds a hash index over a column so equality and In predicates on it
+    // visit only the matching rows instead of scanning the table.
+    void AddIndex(const std::string &name) {
+        size_t c = Resolve(name);
+        const Column &column = columns[c];
+        ColumnIndex index;
+        for (size_t r = 0; r < rows; ++r) {
+            if (!column.numeric) {
+                index.text[std::string(column.text[r])].push_back(r);
+            } else if (!std::isnan(column.values[r])) {
+                index.numbers[column.values[r]].push_back(r);
+            }
+        }
+        indexes[c] = std::move(index);
+    }
+
+    bool HasIndex(const std::string &name) const {
+        int index = IndexOf(name);
+        return index != csv::CSV_NOT_FOUND && indexes.count(index) > 0;
+    }
+
+    // Dictionary encodes a text column. Afterwards GetData returns its codes,
+    // numeric predicates compare the codes, and text predicates are turned
+    // into code comparisons when compiled. Numeric columns are left as they
+    // are.
+    void AddCategorical(const std::string &name) {
+        Column &column = columns[Resolve(name)];
+        if (column.numeric || column.dictionary) {
+            return;
+        }
+        auto dictionary = std::make_shared<Dictionary>();
+        dictionary->codes.resize(rows);
+        std::unordered_map<csv::string_view, uint32_t> codes;
+        for (size_t r = 0; r < rows; ++r) {
+            auto [it, added] =
+                codes.try_emplace(column.text[r], dictionary->values.size());
+            if (added) {
+                dictionary->values.emplace_back(column.text[r]);
+            }
+            dictionary->codes[r] = it->second;
+        }
+        for (uint32_t c = 0; c < dictionary->values.size(); ++c) {
+            dictionary->lookup.emplace(dictionary->values[c], c);
+        }
+        column.dictionary = std::move(dictionary);
+    }
+
+    bool IsCategorical(const std::string &name) const {
+        int index = IndexOf(name);
+        return index != csv::CSV_NOT_FOUND && columns[index].dictionary;
+    }
+
+    // The text of each code of a categorical column.
+    const std::vector<std::string> &
+    GetCategories(const std::string &name) const {
+        const Column &column = GetColumn(name);
+        if (!column.dictionary) {
+            throw std::runtime_error("Column " + name + " is not categorical");
+        }
+        return column.dictionary->values;
+    }
+
+    const std::vector<Column> &GetColumns() const { return columns; }
+    uintmax_t GetFileSize() const { return file_size; }
+    std::filesystem::file_time_type GetModifiedTime() const {
+        return modified_time;
+    }
+
+    size_t Rows() const { return rows; }
+    size_t Cols() const { return columns.size(); }
+
+    int IndexOf(const std::string &name) const {
+        auto it = column_index.find(name);
+        if (it == column_index.end()) {
+            return csv::CSV_NOT_FOUND;
+        }
+        return static_cast<int>(it->second);
+    }
+
+    const Column &GetColumn(const std::string &name) const {
+        return columns[Resolve(name)];
+    }
+
+    // A read only view of a numeric column. It points into the table, so it
+    // is only valid while the table (or the sidecar it maps) is alive.
+    Eigen::Map<const Eigen::VectorXd> MapColumn(const std::string &name) const {
+        const Column &column = GetColumn(name);
+        if (!column.numeric) {
+            throw std::runtime_error("Column " + name + " is not numeric");
+        }
+        return Eigen::Map<const Eigen::VectorXd>(column.values.Data(), rows);
+    }
+
+    // A read only view of several numeric columns at once. This needs the
+    // columns to sit next to each other in memory, in the order given, which
+    // holds for adjacent numeric columns of a table mapped from a sidecar.
+    Eigen::Map<const Eigen::MatrixXd>
+    MapData(const std::vector<std::string> &select_columns) const {
+        if (select_columns.empty()) {
+            return Eigen::Map<const Eigen::MatrixXd>(nullptr, rows, 0);
+        }
+        const double *start = MapColumn(select_columns.front()).data();
+        for (size_t c = 1; c < select_columns.size(); ++c) {
+            if (MapColumn(select_columns[c]).data() != start + c * rows) {
+                throw std::runtime_error(
+                    "Column " + select_columns[c] +
+                    " is not stored right after " + select_columns[c - 1]);
+            }
+        }
+        return Eigen::Map<const Eigen::MatrixXd>(start, rows,
+                                                 select_columns.size());
+    }
+
+    template <typename Scalar = double>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>
+    GetData(const std::vector<std::string> &select_columns,
+            const std::unordered_map<std::string, std::string>
+                &where_conditions) const {
+        return GetData<Scalar>(select_columns,
+                               Predicate::FromConditions(where_conditions));
+    }
+
+    // Rows matching where, in table order.
+    std::vector<size_t> SelectRows(const Predicate &where) const {
+        CompiledPredicate compiled(
+            where,
+            [this](const std::string &name) { return Resolve(name); },
+            [this](int index,
+                   const std::string &value) -> std::optional<double> {
+                const Column &column = columns[index];
+                if (column.numeric && column.text.Size() > 0) {
+                    return std::nullopt;
+                }
+                if (column.numeric) {
+                    // Every field is spelled canonically, so only the
+                    // canonical spelling of a number can match its rows.
+                    double number = ToNumber(value);
+                    return IsCanonical(value, number)
+                               ? number
+                               : std::numeric_limits<double>::quiet_NaN();
+                }
+                if (!column.dictionary) {
+                    return std::nullopt;
+                }
+                auto it = column.dictionary->lookup.find(value);
+                return it == column.dictionary->lookup.end()
+                           ? std::numeric_limits<double>::quiet_NaN()
+                           : it->second;
+            });
+
+        // An equality on an indexed column narrows the scan to the rows that
+        // hold the value; the full predicate is still checked on each of them.
+        std::vector<size_t> candidates;
+        bool indexed = false;
+        auto consider = [&](const Predicate &leaf) {
+            std::vector<size_t> found;
+            if (Lookup(leaf, found) &&
+                (!indexed || found.size() < candidates.size())) {
+                candidates = std::move(found);
+                indexed = true;
+            }
+        };
+        if (where.GetOp() == Predicate::Op::AND) {
+            for (const Predicate &child : where.GetChildren()) {
+                consider(child);
+            }
+        } else {
+            consider(where);
+        }
+
+        std::vector<size_t> selected_rows;
+        size_t count = indexed ? candidates.size() : rows;
+        for (size_t i = 0; i < count; ++i) {
+            size_t r = indexed ? candidates[i] : i;
+            auto number = [this, r](int index) -> double {
+                const Column &column = columns[index];
+                if (column.numeric) {
+                    return column.values[r];
+                }
+                return column.dictionary ? column.dictionary->codes[r]
+                                         : ToNumber(column.text[r]);
+            };
+            auto text = [this, r](int index) {
+                return columns[index].text[r];
+            };
+            if (compiled.Evaluate(number, text)) {
+                selected_rows.push_back(r);
+            }
+        }
+        return selected_rows;
+    }
+
+    template <typename Scalar = double>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>
+    GetData(const std::vector<std::string> &select_columns,
+            const Predicate &where) const {
+        CheckColumns(select_columns, where);
+        std::vector<size_t> selected_rows = SelectRows(where);
+        Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> data(
+            selected_rows.size(), select_columns.size());
+        for (size_t c = 0; c < select_columns.size(); ++c) {
+            const Column &column = GetColumn(select_columns[c]);
+            for (size_t i = 0; i < selected_rows.size(); ++i) {
+                data(i, c) = utils::ConvertValue<Scalar>(
+                    Value(column, selected_rows[i]));
+            }
+        }
+        return data;
+    }
+
+    // Hash aggregation grouped by group_columns over the rows matching
+    // where. Each key column is first reduced to dense codes, the codes are
+    // combined into one group id per row, and every value column is then
+    // folded in a single pass over its contiguous buffer. COUNT gives the
+    // group size for every value column, or a single column if none are
+    // given.
+    GroupedData Aggregate(const std::vector<std::string> &group_columns,
+                          const std::vector<std::string> &value_columns,
+                          Aggregation op,
+                          const Predicate &where = Predicate::All()) const {
+        std::vector<size_t> selected_rows = SelectRows(where);
+        const size_t n = selected_rows.size();
+
+        std::vector<uint64_t> group(n, 0);
+        for (const std::string &name : group_columns) {
+            const Column &column = GetColumn(name);
+            std::vector<uint64_t> code;
+            uint64_t distinct = 0;
+            if (column.dictionary) {
+                code.resize(n);
+                for (size_t i = 0; i < n; ++i) {
+                    code[i] = column.dictionary->codes[selected_rows[i]];
+                }
+                distinct = column.dictionary->values.size();
+            } else {
+                distinct = DenseCodes(column, selected_rows, code);
+            }
+            std::unordered_map<uint64_t, uint64_t> combine;
+            CombineCodes(group, code, distinct, combine);
+        }
+
+        // Ids are handed out in order of first appearance
+        std::vector<size_t> first_row;
+        for (size_t i = 0; i < n; ++i) {
+            if (group[i] == first_row.size()) {
+                first_row.push_back(selected_rows[i]);
+            }
+        }
+        const size_t groups = first_row.size();
+
+        GroupedData result;
+        result.group_columns = group_columns;
+        for (size_t row : first_row) {
+            std::vector<std::string> key;
+            for (const std::string &name : group_columns) {
+                const Column &column = GetColumn(name);
+                key.push_back(column.numeric ? FormatNumber(column.values[row])
+                                             : std::string(column.text[row]));
+            }
+            result.keys.push_back(std::move(key));
+        }
+
+        Eigen::VectorXd counts = Eigen::VectorXd::Zero(groups);
+        for (size_t i = 0; i < n; ++i) {
+            counts[group[i]] += 1;
+        }
+        if (op == Aggregation::COUNT) {
+            result.values = counts.replicate(
+                1, std::max<Eigen::Index>(value_columns.size(), 1));
+            return result;
+        }
+
+        result.values.resize(groups, value_columns.size());
+        for (size_t c = 0; c < value_columns.size(); ++c) {
+            const Column &column = GetColumn(value_columns[c]);
+            Eigen::VectorXd acc(groups);
+            if (op == Aggregation::MIN) {
+                acc.setConstant(std::numeric_limits<double>::infinity());
+            } else if (op == Aggregation::MAX) {
+                acc.setConstant(-std::numeric_limits<double>::infinity());
+            } else {
+                acc.setZero();
+            }
+            for (size_t i = 0; i < n; ++i) {
+                double value = Value(column, selected_rows[i]);
+                double &slot = acc[group[i]];
+                if (op == Aggregation::MIN) {
+                    slot = std::min(slot, value);
+                } else if (op == Aggregation::MAX) {
+                    slot = std::max(slot, value);
+                } else {
+                    slot += value;
+                }
+            }
+            if (op == Aggregation::MEAN) {
+                acc.array() /= counts.array();
+            }
+            result.values.col(c) = acc;
+        }
+        return result;
+    }
+
+    // Pivots a long format table into a dense StratifiedTable over the
+    // distinct values of dimension_columns, holding value_column of the
+    // rows matching where. Levels of numeric dimensions are sorted, levels
+    // of text dimensions keep their order of first appearance. Throws if
+    // two rows describe the same stratum.
+    StratifiedTable
+    Stratify(const std::vector<std::string> &dimension_columns,
+             const std::string &value_column,
+             const Predicate &where = Predicate::All()) const {
+        std::vector<size_t> selected_rows = SelectRows(where);
+        const size_t n = selected_rows.size();
+        const Column &value = GetColumn(value_column);
+
+        std::vector<std::vector<std::string>> levels;
+        std::vector<size_t> offset(n, 0);
+        for (const std::string &name : dimension_columns) {
+            const Column &column = GetColumn(name);
+            std::vector<size_t> level(n);
+            std::vector<std::string> labels;
+            if (column.numeric) {
+                std::vector<double> distinct;
+                for (size_t row : selected_rows) {
+                    distinct.push_back(column.values[row]);
+                }
+                std::sort(distinct.begin(), distinct.end());
+                distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                               distinct.end());
+                for (size_t i = 0; i < n; ++i) {
+                    double number = column.values[selected_rows[i]];
+                    level[i] = std::lower_bound(distinct.begin(),
+                                                distinct.end(), number) -
+                               distinct.begin();
+                }
+                for (double number : distinct) {
+                    labels.push_back(FormatNumber(number));
+                }
+            } else {
+                std::vector<uint64_t> code;
+                std::vector<size_t> first;
+                DenseCodes(column, selected_rows, code, &first);
+                level.assign(code.begin(), code.end());
+                for (size_t i : first) {
+                    labels.emplace_back(column.text[selected_rows[i]]);
+                }
+            }
+            for (size_t i = 0; i < n; ++i) {
+                offset[i] = offset[i] * labels.size() + level[i];
+            }
+            levels.push_back(std::move(labels));
+        }
+
+        StratifiedTable table(dimension_columns, std::move(levels));
+        std::vector<bool> filled(table.Size(), false);
+        for (size_t i = 0; i < n; ++i) {
+            if (filled[offset[i]]) {
+                std::string stratum;
+                for (const std::string &name : dimension_columns) {
+                    const Column &column = GetColumn(name);
+                    size_t row = selected_rows[i];
+                    stratum += (stratum.empty() ? "" : ", ") +
+                               (column.numeric
+                                    ? FormatNumber(column.values[row])
+                                    : std::string(column.text[row]));
+                }
+                throw std::runtime_error("Stratum (" + stratum +
+                                         ") appears more than once");
+            }
+            filled[offset[i]] = true;
+            table.Data()[offset[i]] = Value(value, selected_rows[i]);
+        }
+        return table;
+    }
+
+    // Inner equi-join of left and right on key_columns, which must exist in
+    // both tables. Each output row holds the left_select values of a left
+    // row followed by the right_select values of a matching right row, in
+    // order of left row and then right row.
+    //
+    // The smaller table is hashed: every key column is reduced to dense
+    // codes and the codes are combined into one key id per row, as in
+    // Aggregate. The other table is then probed in threads contiguous
+    // slices. Keys compare as text when both sides hold text and as numbers
+    // otherwise, so "7" joins 7.0; a key that is not a number never matches
+    // a numeric one.
+    static Eigen::MatrixXd Join(const ColumnTable &left,
+                                const ColumnTable &right,
+                                const std::vector<std::string> &key_columns,
+                                const std::vector<std::string> &left_select,
+                                const std::vector<std::string> &right_select,
+                                size_t threads = 1) {
+        if (key_columns.empty()) {
+            throw std::runtime_error("Join needs at least one key column");
+        }
+        std::vector<const Column *> left_columns, right_columns;
+        for (const std::string &name : left_select) {
+            left_columns.push_back(&left.GetColumn(name));
+        }
+        for (const std::string &name : right_select) {
+            right_columns.push_back(&right.GetColumn(name));
+        }
+
+        const bool build_left = left.rows <= right.rows;
+        const ColumnTable &build = build_left ? left : right;
+        const ColumnTable &probe = build_left ? right : left;
+
+        // Dense codes of the build side's values of one key column
+        struct KeyCodes {
+            const Column *build;
+            const Column *probe;
+            bool numeric;
+            std::unordered_map<double, uint64_t> numbers = {};
+            std::unordered_map<csv::string_view, uint64_t> text = {};
+
+            double Number(const Column &column, size_t row) const {
+                return column.numeric ? column.values[row]
+                                      : ToNumber(column.text[row]);
+            }
+
+            uint64_t Add(size_t row) {
+                if (!numeric) {
+                    return text.try_emplace(build->text[row], text.size())
+                        .first->second;
+                }
+                double value = Number(*build, row);
+                if (std::isnan(value)) {
+                    return MISSING_CODE;
+                }
+                return numbers.try_emplace(value, numbers.size())
+                    .first->second;
+            }
+
+            uint64_t Find(size_t row) const {
+                if (!numeric) {
+                    auto it = text.find(probe->text[row]);
+                    return it == text.end() ? MISSING_CODE : it->second;
+                }
+                auto it = numbers.find(Number(*probe, row));
+                return it == numbers.end() ? MISSING_CODE : it->second;
+            }
+
+            uint64_t Distinct() const {
+                return numeric ? numbers.size() : text.size();
+            }
+        };
+
+        std::vector<KeyCodes> keys;
+        for (const std::string &name : key_columns) {
+            const Column &b = build.GetColumn(name);
+            const Column &p = probe.GetColumn(name);
+            keys.push_back({&b, &p, b.numeric || p.numeric});
+        }
+
+        // Key id of every build row: the codes of the first key column, then
+        // each further column folded in by CombineCodes. combine[k - 1] maps
+        // the id over the first k key columns and the code of column k to
+        // the next id.
+        std::vector<uint64_t> id(build.rows);
+        for (size_t r = 0; r < build.rows; ++r) {
+            id[r] = keys[0].Add(r);
+        }
+        std::vector<std::unordered_map<uint64_t, uint64_t>> combine(
+            keys.size() - 1);
+        for (size_t k = 1; k < keys.size(); ++k) {
+            std::vector<uint64_t> code(build.rows);
+            for (size_t r = 0; r < build.rows; ++r) {
+                code[r] = keys[k].Add(r);
+            }
+            CombineCodes(id, code, keys[k].Distinct(), combine[k - 1]);
+        }
+
+        // Build rows grouped by key id, ascending within each group
+        const uint64_t ids =
+            keys.size() == 1 ? keys[0].Distinct() : combine.back().size();
+        std::vector<size_t> starts(ids + 1, 0);
+        for (uint64_t value : id) {
+            if (value != MISSING_CODE) {
+                ++starts[value + 1];
+            }
+        }
+        for (uint64_t i = 0; i < ids; ++i) {
+            starts[i + 1] += starts[i];
+        }
+        std::vector<size_t> bucket(starts.back());
+        std::vector<size_t> fill(starts.begin(), starts.end() - 1);
+        for (size_t r = 0; r < build.rows; ++r) {
+            if (id[r] != MISSING_CODE) {
+                bucket[fill[id[r]]++] = r;
+            }
+        }
+
+        // Matching (probe row, build row) pairs of probe rows [begin, end)
+        using Pairs = std::vector<std::pair<size_t, size_t>>;
+        auto match = [&](size_t begin, size_t end) {
+            Pairs pairs;
+            for (size_t r = begin; r < end; ++r) {
+                uint64_t value = keys[0].Find(r);
+                for (size_t k = 1; k < keys.size() && value != MISSING_CODE;
+                     ++k) {
+                    uint64_t code = keys[k].Find(r);
+                    if (code == MISSING_CODE) {
+                        value = MISSING_CODE;
+                        break;
+                    }
+                    auto it = combine[k - 1].find(value * keys[k].Distinct() +
+                                                  code);
+                    value = it == combine[k - 1].end() ? MISSING_CODE
+                                                       : it->second;
+                }
+                if (value == MISSING_CODE) {
+                    continue;
+                }
+                for (size_t i = starts[value]; i < starts[value + 1]; ++i) {
+                    pairs.emplace_back(r, bucket[i]);
+                }
+            }
+            return pairs;
+        };
+
+        Pairs pairs;
+        threads =
+            std::clamp<size_t>(threads, 1, std::max<size_t>(probe.rows, 1));
+        if (threads == 1) {
+            pairs = match(0, probe.rows);
+        } else {
+            utils::ThreadPool pool(threads);
+            std::vector<std::future<Pairs>> parts;
+            size_t slice = (probe.rows + threads - 1) / threads;
+            for (size_t begin = 0; begin < probe.rows; begin += slice) {
+                size_t end = std::min(begin + slice, probe.rows);
+                parts.push_back(pool.Submit(
+                    [&match, begin, end]() { return match(begin, end); }));
+            }
+            for (auto &part : parts) {
+                Pairs found = part.get();
+                pairs.insert(pairs.end(), found.begin(), found.end());
+            }
+        }
+        if (build_left) {
+            for (auto &[probe_row, build_row] : pairs) {
+                std::swap(probe_row, build_row);
+            }
+            std::sort(pairs.begin(), pairs.end());
+        }
+
+        Eigen::MatrixXd data(pairs.size(),
+                             left_columns.size() + right_columns.size());
+        for (size_t c = 0; c < left_columns.size(); ++c) {
+            for (size_t i = 0; i < pairs.size(); ++i) {
+                data(i, c) = Value(*left_columns[c], pairs[i].first);
+            }
+        }
+        for (size_t c = 0; c < right_columns.size(); ++c) {
+            Eigen::Index column = left_columns.size() + c;
+            for (size_t i = 0; i < pairs.size(); ++i) {
+                data(i, column) = Value(*right_columns[c], pairs[i].second);
+            }
+        }
+        return data;
+    }
+
+    // Like GetData, but only the non-zero values are collected.
+    template <typename Scalar = double>
+    Eigen::SparseMatrix<Scalar>
+    GetSparseData(const std::vector<std::string> &select_columns,
+                  const Predicate &where) const {
+        CheckColumns(select_columns, where);
+        std::vector<size_t> selected_rows = SelectRows(where);
+        std::vector<Eigen::Triplet<Scalar>> triplets;
+        for (size_t c = 0; c < select_columns.size(); ++c) {
+            const Column &column = GetColumn(select_columns[c]);
+            for (size_t i = 0; i < selected_rows.size(); ++i) {
+                Scalar value = utils::ConvertValue<Scalar>(
+                    Value(column, selected_rows[i]));
+                if (value != Scalar(0)) {
+                    triplets.emplace_back(i, c, value);
+                }
+            }
+        }
+        Eigen::SparseMatrix<Scalar> data(selected_rows.size(),
+                                         select_columns.size());
+        data.setFromTriplets(triplets.begin(), triplets.end());
+        return data;
+    }
+};
+} // namespace datamanagement::source
+
+#endif // DATAMANAGEMENT_SOURCE_COLUMNTABLE_HPP_
@@ -4,7 +4,7 @@
 // Created Date: Th Feb 2025                                                  //
 // Author: Matthew Carroll                                                    //
 // -----                                                                      //
-// Last Modified: Fri Feb 21 2025                                             //
+// Last Modified: Sat Oct 17 2026                                             //
 // Modified By: Matthew Carroll                                               //
 // -----                                                                      //
 // Copyright (c) 2025 Syndemics Lab at Boston Medical Center                  //
@@ -19,63 +19,681 @@
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <algorithm>
+#include <datamanagement/source/column_table.hpp>
+#include <datamanagement/source/predicate.hpp>
+#include <datamanagement/source/sidecar.hpp>
+#include <datamanagement/source/stratified_table.hpp>
+#include <datamanagement/utils/convert.hpp>
 #include <datamanagement/utils/csv.hpp>
+#include <datamanagement/utils/matrix_builder.hpp>
+#include <datamanagement/utils/thread_pool.hpp>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace datamanagement::source {
+// Layout of a csv file as seen in its first few kilobytes (see
+// CSVSource::GetSchema).
+struct Schema {
+    char delimiter = ',';
+    int header_row = 0;
+    std::vector<std::string> columns = {};
+    // Widest type found in each column over the sampled rows: CSV_NULL when
+    // every sampled field was empty, CSV_STRING when any was not a number.
+    std::vector<csv::DataType> types = {};
+    size_t sampled_rows = 0;
+};
+
+// Const reads (GetData, GetTable, Aggregate and the rest) may run on one
+// source from several threads at once: the cache they fill is guarded by a
+// mutex. Configuring the source (ConnectToFile, the setters, AddIndex,
+// AddCategorical, Prefetch) must not overlap with reads.
 class CSVSource {
 private:
     std::string filepath;
+    bool caching = false;
+    bool sidecar = false;
+    size_t threads = 1;
+    std::vector<std::string> index_columns = {};
+    std::vector<std::string> categorical_columns = {};
+    mutable std::shared_ptr<ColumnTable> cache = nullptr;
+    // The table being built in the background by Prefetch, if any
+    mutable std::shared_future<std::shared_ptr<ColumnTable>> pending = {};
+    // Guards cache and pending. Held by pointer so sources stay movable;
+    // copies share it and only take turns.
+    std::shared_ptr<std::mutex> cache_mutex = std::make_shared<std::mutex>();
+
+    // Select and where columns resolved to field indices once per query so
+    // the row loop never looks up a column by name.
+    struct QueryPlan {
+        std::vector<int> select;
+        CompiledPredicate where;
+
+        // Every field the query reads, so the parser can skip the rest.
+        std::vector<size_t> Projection() const {
+            std::vector<size_t> columns(select.begin(), select.end());
+            for (int column : where.GetColumns()) {
+                columns.push_back(column);
+            }
+            return columns;
+        }
+    };
+
+    // A format that only records the fields a query reads, from the first
+    // row on.
+    static csv::CSVFormat
+    Projected(const std::vector<std::string> &select_columns,
+              const Predicate &where) {
+        std::vector<std::string> columns = select_columns;
+        for (const std::string &column : where.GetColumns()) {
+            columns.push_back(column);
+        }
+        return csv::CSVFormat::guess_csv().project(columns);
+    }
+
+    static QueryPlan Compile(const std::vector<std::string> &col_names,
+                             const std::vector<std::string> &select_columns,
+                             const Predicate &where) {
+        csv::internals::ColNames names(col_names);
+        std::vector<std::string> missing;
+        auto resolve = [&](const std::string &col) {
+            int index = names.index_of(col);
+            if (index == csv::CSV_NOT_FOUND &&
+                std::find(missing.begin(), missing.end(), col) ==
+                    missing.end()) {
+                missing.push_back(col);
+            }
+            return index;
+        };
+
+        std::vector<int> select;
+        for (const std::string &col : select_columns) {
+            select.push_back(resolve(col));
+        }
+        QueryPlan plan{std::move(select), CompiledPredicate(where, resolve)};
+
+        if (!missing.empty()) {
+            std::string message = "Can't find columns named:";
+            for (const std::string &col : missing) {
+                message += " " + col;
+            }
+            throw std::runtime_error(message);
+        }
+        return plan;
+    }
 
-    bool CheckWhereConditions(const csv::CSVRow &row,
-                              const std::unordered_map<std::string, std::string>
-                                  &where_conditions) const {
-        if (where_conditions.empty()) {
-            return true;
+    // Returns the offset just past the record containing pos, where quoted
+    // tells whether pos is inside a quoted field. A run of newline characters
+    // ends a record, matching how the csv parser skips blank lines.
+    static size_t SkipRecord(csv::string_view in, size_t pos, char quote,
+                             bool quoted = false) {
+        while (pos < in.size()) {
+            char ch = in[pos++];
+            if (ch == quote) {
+                quoted = !quoted;
+            } else if (!quoted && (ch == '\n' || ch == '\r')) {
+                while (pos < in.size() &&
+                       (in[pos] == '\n' || in[pos] == '\r')) {
+                    ++pos;
+                }
+                break;
+            }
+        }
+        return pos;
+    }
+
+    // Splits in[start, end) into pieces of roughly chunk_size bytes that each
+    // begin at a record boundary. The quote state at the tentative cut is
+    // recovered from the parity of quote characters since the last boundary.
+    static std::vector<size_t> SplitRecords(csv::string_view in, size_t start,
+                                            size_t chunk_size, char quote) {
+        std::vector<size_t> bounds = {start};
+        while (bounds.back() < in.size()) {
+            size_t begin = bounds.back();
+            size_t cut = std::min(begin + chunk_size, in.size());
+            size_t quotes =
+                std::count(in.begin() + begin, in.begin() + cut, quote);
+            bounds.push_back(SkipRecord(in, cut, quote, quotes % 2 == 1));
         }
-        for (auto &condition : where_conditions) {
-            if (row[condition.first].get<std::string>() != condition.second) {
-                return false;
+        return bounds;
+    }
+
+    // Loads the table of path from its sidecar when allowed and current,
+    // otherwise parses the csv (and writes the sidecar when allowed), then
+    // adds the requested dictionaries and indexes that are missing. Touches
+    // no member, so it can run on another thread.
+    static std::shared_ptr<ColumnTable>
+    BuildTable(const std::string &path, bool use_sidecar,
+               const std::vector<std::string> &categoricals,
+               const std::vector<std::string> &indexes) {
+        std::shared_ptr<ColumnTable> table;
+        std::shared_ptr<const Sidecar> stored =
+            use_sidecar ? Sidecar::Open(path) : nullptr;
+        if (stored) {
+            table = std::make_shared<ColumnTable>(stored->ToTable(path));
+        } else {
+            table = std::make_shared<ColumnTable>();
+            ColumnTable::Load(path, *table);
+            if (use_sidecar) {
+                Sidecar::Write(*table, path);
             }
         }
-        return true;
+        Prepare(*table, categoricals, indexes);
+        return table;
+    }
+
+    static void Prepare(ColumnTable &table,
+                        const std::vector<std::string> &categoricals,
+                        const std::vector<std::string> &indexes) {
+        // A column can vanish when the file is rewritten; skipping it keeps
+        // the table usable, and any query on it reports it missing.
+        for (const std::string &column : categoricals) {
+            if (table.IndexOf(column) != csv::CSV_NOT_FOUND) {
+                table.AddCategorical(column);
+            }
+        }
+        for (const std::string &column : indexes) {
+            if (table.IndexOf(column) != csv::CSV_NOT_FOUND &&
+                !table.HasIndex(column)) {
+                table.AddIndex(column);
+            }
+        }
+    }
+
+    // Throws unless the file has a column named column, so a bad name is
+    // never stored for later builds. Reads only the header.
+    void CheckColumn(const std::string &column) const {
+        std::vector<std::string> names = GetSchema().columns;
+        if (std::find(names.begin(), names.end(), column) == names.end()) {
+            throw std::runtime_error("Can't find a column named " + column);
+        }
+    }
+
+    // The cached table, built or rebuilt first when needed. Holding the
+    // pointer keeps the table alive if another thread replaces the cache.
+    std::shared_ptr<const ColumnTable> Table() const {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        if (pending.valid()) {
+            auto prefetched = std::move(pending);
+            pending = {};
+            cache = prefetched.get();
+            // Catch up on dictionaries and indexes declared meanwhile
+            Prepare(*cache, categorical_columns, index_columns);
+        }
+        if (!cache || cache->IsStale(filepath)) {
+            cache = BuildTable(filepath, sidecar, categorical_columns,
+                               index_columns);
+        }
+        return cache;
+    }
+
+    // Calls f with the cached table when caching is on, otherwise with a
+    // table loaded for this call only.
+    template <typename F> auto WithTable(const F &f) const {
+        if (caching) {
+            return f(*Table());
+        }
+        return f(ColumnTable::Load(filepath));
+    }
+
+    template <typename Scalar>
+    static utils::MatrixBuilder<Scalar>
+    ParseChunk(csv::string_view chunk, const std::shared_ptr<void> &owner,
+               const csv::CSVFormat &format,
+               const csv::internals::ColNamesPtr &col_names,
+               const QueryPlan &plan) {
+        csv::RowCollection rows;
+        csv::internals::StringViewParser parser(chunk, owner, format,
+                                                col_names);
+        parser.set_projection(plan.Projection());
+        parser.set_output(rows);
+        parser.next();
+
+        utils::MatrixBuilder<Scalar> builder(plan.select.size());
+        for (csv::CSVRow &row : rows) {
+            if (row.size() != col_names->size() ||
+                !plan.where.Matches(row)) {
+                continue;
+            }
+            builder.AddRow();
+            for (size_t c = 0; c < plan.select.size(); ++c) {
+                builder(c) =
+                    utils::ConvertField<Scalar>(row[plan.select[c]]);
+            }
+        }
+        return builder;
+    }
+
+    // Memory maps the whole file, cuts the body into record aligned chunks
+    // and parses them concurrently. Chunk results are stitched back together
+    // in file order.
+    template <typename Scalar>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>
+    ParallelGetData(const std::vector<std::string> &select_columns,
+                    const Predicate &where) const {
+        std::error_code error;
+        auto mmap = std::make_shared<mio::mmap_source>(
+            mio::make_mmap_source(filepath, error));
+        if (error) {
+            throw std::runtime_error("Cannot open file " + filepath);
+        }
+        csv::string_view in(mmap->data(), mmap->size());
+
+        csv::CSVFormat format = csv::CSVFormat::guess_csv();
+        std::string head = csv::internals::get_csv_head(filepath, in.size());
+        csv::CSVGuessResult guess = csv::internals::_guess_format(
+            head, format.get_possible_delims());
+        format.delimiter(guess.delim).header_row(guess.header_row);
+        auto col_names = std::make_shared<csv::internals::ColNames>(
+            csv::internals::_get_col_names(head, format));
+
+        QueryPlan plan =
+            Compile(col_names->get_col_names(), select_columns, where);
+
+        const char quote = format.get_quote_char();
+        size_t start = 0;
+        for (int i = 0; i <= guess.header_row; ++i) {
+            start = SkipRecord(in, start, quote);
+        }
+        size_t chunk_size =
+            std::clamp<size_t>((in.size() - start) / threads + 1, 1,
+                               csv::internals::ITERATION_CHUNK_SIZE);
+        std::vector<size_t> bounds = SplitRecords(in, start, chunk_size, quote);
+
+        utils::ThreadPool pool(threads);
+        std::vector<std::future<utils::MatrixBuilder<Scalar>>> parts;
+        for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+            csv::string_view chunk =
+                in.substr(bounds[i], bounds[i + 1] - bounds[i]);
+            parts.push_back(pool.Submit([&, chunk]() {
+                return ParseChunk<Scalar>(chunk, mmap, format, col_names,
+                                          plan);
+            }));
+        }
+
+        utils::MatrixBuilder<Scalar> builder(plan.select.size());
+        for (auto &part : parts) {
+            builder.Append(part.get());
+        }
+        return builder.Finish();
     }
 
 public:
     CSVSource() {}
     ~CSVSource() = default;
 
-    void ConnectToFile(const std::string &s) { filepath = s; }
+    void ConnectToFile(const std::string &s) {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        filepath = s;
+        cache.reset();
+        pending = {};
+    }
+
+    // When caching is enabled the file is parsed once into per-column buffers
+    // and later calls to GetData are answered from memory. The cache is
+    // rebuilt if the file's size or modification time changes.
+    void SetCaching(bool enable) {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        caching = enable;
+        if (!caching) {
+            sidecar = false;
+            cache.reset();
+            pending = {};
+        }
+    }
+
+    bool IsCaching() const { return caching; }
+
+    // With a sidecar the cached table is also written next to the csv as a
+    // binary columnar file (see Sidecar). Later processes load the table
+    // from that file without parsing text, for as long as the csv is
+    // unchanged. Turning this on also turns on caching.
+    void SetSidecar(bool enable) {
+        sidecar = enable;
+        caching = caching || enable;
+    }
+
+    bool IsSidecar() const { return sidecar; }
+
+    // Uncached reads with more than one thread split the file at record
+    // boundaries and parse the pieces concurrently.
+    void SetThreads(size_t count) { threads = std::max<size_t>(count, 1); }
+
+    size_t GetThreads() const { return threads; }
+
+    // Declares a hash index on a key column, built from the cached table and
+    // rebuilt with it. Equality and In filters on the column then resolve to
+    // the matching rows without a scan. Indexes need the cache, so this also
+    // turns caching on.
+    void AddIndex(const std::string &column) {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        if (cache) {
+            cache->AddIndex(column);
+        } else {
+            CheckColumn(column);
+        }
+        caching = true;
+        if (std::find(index_columns.begin(), index_columns.end(), column) ==
+            index_columns.end()) {
+            index_columns.push_back(column);
+        }
+    }
+
+    const std::vector<std::string> &GetIndexes() const {
+        return index_columns;
+    }
+
+    // Declares a text column categorical: the cached table dictionary
+    // encodes it, giving each distinct value a dense integer code. GetData
+    // then returns the codes instead of failing on text, and filters on the
+    // column compare codes (see ColumnTable::AddCategorical). This also
+    // turns caching on.
+    void AddCategorical(const std::string &column) {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        if (cache) {
+            cache->AddCategorical(column);
+        } else {
+            CheckColumn(column);
+        }
+        caching = true;
+        if (std::find(categorical_columns.begin(), categorical_columns.end(),
+                      column) == categorical_columns.end()) {
+            categorical_columns.push_back(column);
+        }
+    }
+
+    const std::vector<std::string> &GetCategoricals() const {
+        return categorical_columns;
+    }
+
+    // The value each code of a categorical column stands for.
+    const std::vector<std::string> &
+    GetCategories(const std::string &column) const {
+        return GetTable().GetCategories(column);
+    }
+
+    // Starts building the cached table on pool, so the first GetTable (or
+    // GetData) only waits for that build instead of parsing the file
+    // itself. Errors surface from that first call. Turns caching on.
+    void Prefetch(utils::ThreadPool &pool) {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        caching = true;
+        cache.reset();
+        auto build = [path = filepath, use_sidecar = sidecar,
+                      categoricals = categorical_columns,
+                      indexes = index_columns]() {
+            return BuildTable(path, use_sidecar, categoricals, indexes);
+        };
+        pending = pool.Submit(std::move(build)).share();
+    }
+
+    bool IsPrefetching() const {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        return pending.valid();
+    }
+
+    // The reference stays valid until the cache is rebuilt, which a read on
+    // any thread does once the file changes.
+    const ColumnTable &GetTable() const { return *Table(); }
 
     std::string GetName() const {
         std::filesystem::path p = filepath;
         return p.filename().string();
     }
 
-    Eigen::MatrixXd GetData(const std::vector<std::string> &select_columns,
-                            const std::unordered_map<std::string, std::string>
-                                &where_conditions) const {
-        std::vector<std::vector<double>> temp_data;
-        csv::CSVReader reader(filepath);
+    // Reads the header, delimiter and column types from the first
+    // probe_bytes of the file (more if the header alone is longer), without
+    // starting a reader or touching the cache. Only complete rows in that
+    // prefix are sampled for types.
+    Schema GetSchema(size_t probe_bytes = 1 << 12) const {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(filepath, ec);
+        if (ec) {
+            throw std::runtime_error("Cannot open file " + filepath);
+        }
+        std::string head;
+        size_t end = std::string::npos;
+        for (size_t bytes = std::max<size_t>(probe_bytes, 1);;) {
+            head = csv::internals::get_csv_head(
+                filepath, std::min<uintmax_t>(size, bytes));
+            end = head.rfind('\n');
+            if (head.size() == size || end != std::string::npos ||
+                head.size() < bytes) {
+                break;
+            }
+            bytes *= 4;
+        }
+        if (head.size() < size && end != std::string::npos) {
+            head.resize(end + 1);
+        }
+
+        csv::CSVFormat format = csv::CSVFormat::guess_csv();
+        csv::CSVGuessResult guess = csv::internals::_guess_format(
+            head, format.get_possible_delims());
+        format.delimiter(guess.delim).header_row(guess.header_row);
+        auto col_names = std::make_shared<csv::internals::ColNames>(
+            csv::internals::_get_col_names(head, format));
+
+        Schema schema;
+        schema.delimiter = guess.delim;
+        schema.header_row = guess.header_row;
+        schema.columns = col_names->get_col_names();
+        schema.types.assign(schema.columns.size(), csv::DataType::CSV_NULL);
+
+        size_t start = 0;
+        for (int i = 0; i <= guess.header_row; ++i) {
+            start = SkipRecord(head, start, format.get_quote_char());
+        }
+        // The parser keeps rows alive through an owner of their text
+        auto owner = std::make_shared<std::string>(std::move(head));
+        csv::RowCollection rows;
+        csv::internals::StringViewParser parser(
+            csv::string_view(*owner).substr(start), owner, format, col_names);
+        parser.set_output(rows);
+        parser.next();
+        for (csv::CSVRow &row : rows) {
+            if (row.size() != schema.columns.size()) {
+                continue;
+            }
+            for (size_t c = 0; c < row.size(); ++c) {
+                csv::DataType &type = schema.types[c];
+                csv::DataType found = row[c].type();
+                if (found == csv::DataType::CSV_STRING ||
+                    type == csv::DataType::CSV_STRING) {
+                    type = csv::DataType::CSV_STRING;
+                } else {
+                    type = std::max(type, found);
+                }
+            }
+            ++schema.sampled_rows;
+        }
+        return schema;
+    }
+
+    // Scalar picks the matrix type, e.g. GetData<float> for probabilities or
+    // GetData<int> for ids and counts. Fields are converted straight to
+    // Scalar while scanning; integral types throw on fractions and overflow.
+    template <typename Scalar = double>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>
+    GetData(const std::vector<std::string> &select_columns,
+            const std::unordered_map<std::string, std::string>
+                &where_conditions) const {
+        return GetData<Scalar>(select_columns,
+                               Predicate::FromConditions(where_conditions));
+    }
+
+    // Rows are filtered while the file is scanned, so only matching rows are
+    // ever converted and stored.
+    template <typename Scalar = double>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>
+    GetData(const std::vector<std::string> &select_columns,
+            const Predicate &where) const {
+        if (caching) {
+            return Table()->GetData<Scalar>(select_columns, where);
+        }
+        if (threads > 1) {
+            return ParallelGetData<Scalar>(select_columns, where);
+        }
+        csv::CSVReader reader(filepath, Projected(select_columns, where));
+        QueryPlan plan = Compile(reader.get_col_names(), select_columns, where);
+        utils::MatrixBuilder<Scalar> builder(plan.select.size());
         for (csv::CSVRow &row : reader) {
-            if (CheckWhereConditions(row, where_conditions)) {
-                std::vector<double> temp_row;
-                for (const std::string &col : select_columns) {
-                    temp_row.push_back(row[col].get<double>());
+            if (plan.where.Matches(row)) {
+                builder.AddRow();
+                for (size_t c = 0; c < plan.select.size(); ++c) {
+                    builder(c) =
+                        utils::ConvertField<Scalar>(row[plan.select[c]]);
                 }
-                temp_data.push_back(temp_row);
             }
         }
-        Eigen::MatrixXd data(temp_data.size(), select_columns.size());
-        for (int i = 0; i < temp_data.size(); ++i) {
-            data.row(i) = Eigen::Map<Eigen::VectorXd>(temp_data[i].data(),
-                                                      temp_data[i].size());
+        return builder.Finish();
+    }
+
+    // Builds a sparse matrix straight from the scan, keeping triplets only
+    // for non-zero values, for tables that are mostly zeros. Uncached reads
+    // always scan on the calling thread.
+    template <typename Scalar = double>
+    Eigen::SparseMatrix<Scalar>
+    GetSparseData(const std::vector<std::string> &select_columns,
+                  const Predicate &where) const {
+        if (caching) {
+            return Table()->GetSparseData<Scalar>(select_columns, where);
         }
+        csv::CSVReader reader(filepath, Projected(select_columns, where));
+        QueryPlan plan = Compile(reader.get_col_names(), select_columns, where);
+        std::vector<Eigen::Triplet<Scalar>> triplets;
+        Eigen::Index rows = 0;
+        for (csv::CSVRow &row : reader) {
+            if (!plan.where.Matches(row)) {
+                continue;
+            }
+            for (size_t c = 0; c < plan.select.size(); ++c) {
+                Scalar value = utils::ConvertField<Scalar>(row[plan.select[c]]);
+                if (value != Scalar(0)) {
+                    triplets.emplace_back(rows, c, value);
+                }
+            }
+            ++rows;
+        }
+        Eigen::SparseMatrix<Scalar> data(rows, plan.select.size());
+        data.setFromTriplets(triplets.begin(), triplets.end());
         return data;
     }
 
+    template <typename Scalar = double>
+    Eigen::SparseMatrix<Scalar>
+    GetSparseData(const std::vector<std::string> &select_columns,
+                  const std::unordered_map<std::string, std::string>
+                      &where_conditions) const {
+        return GetSparseData<Scalar>(
+            select_columns, Predicate::FromConditions(where_conditions));
+    }
+
+    // Sums, averages, extremes or counts value_columns grouped by
+    // group_columns (see ColumnTable::Aggregate). Runs over the cache when
+    // caching is on, otherwise over a table loaded for this call only.
+    GroupedData Aggregate(const std::vector<std::string> &group_columns,
+                          const std::vector<std::string> &value_columns,
+                          Aggregation op,
+                          const Predicate &where = Predicate::All()) const {
+        return WithTable([&](const ColumnTable &table) {
+            return table.Aggregate(group_columns, value_columns, op, where);
+        });
+    }
+
+    // Pivots the source into a dense lookup table over the distinct values
+    // of dimension_columns (see ColumnTable::Stratify), so repeated lookups
+    // by stratum index straight into an array instead of filtering rows.
+    StratifiedTable
+    Stratify(const std::vector<std::string> &dimension_columns,
+             const std::string &value_column,
+             const Predicate &where = Predicate::All()) const {
+        return WithTable([&](const ColumnTable &table) {
+            return table.Stratify(dimension_columns, value_column, where);
+        });
+    }
+
+    // Inner join with other on key_columns (see ColumnTable::Join): each row
+    // holds select_columns of this source followed by other_select of the
+    // matching row of other. The smaller side is hashed and the larger one
+    // probed with as many threads as this source is set to use.
+    Eigen::MatrixXd Join(const CSVSource &other,
+                         const std::vector<std::string> &key_columns,
+                         const std::vector<std::string> &select_columns,
+                         const std::vector<std::string> &other_select) const {
+        return WithTable([&](const ColumnTable &table) {
+            return other.WithTable([&](const ColumnTable &other_table) {
+                return ColumnTable::Join(table, other_table, key_columns,
+                                         select_columns, other_select,
+                                         threads);
+            });
+        });
+    }
+
+    // Zero-copy views of cached numeric columns. With a sidecar they point
+    // straight into the mapped file, so concurrent processes reading the same
+    // input share one page cache copy instead of each holding a matrix.
+    // Views are invalidated when the cache is rebuilt, the source reconnects
+    // or the source is destroyed. MapData needs the columns to be adjacent
+    // numeric columns of the sidecar, in file order.
+    Eigen::Map<const Eigen::MatrixXd>
+    MapData(const std::vector<std::string> &select_columns) const {
+        return GetTable().MapData(select_columns);
+    }
+
+    Eigen::Map<const Eigen::VectorXd> MapColumn(const std::string &name) const {
+        return GetTable().MapColumn(name);
+    }
+
+    using BlockCallback =
+        std::function<void(const Eigen::Ref<const Eigen::MatrixXd> &)>;
+
+    // Streams the selected columns of matching rows to callback in blocks of
+    // block_rows rows (the last block may be shorter) as the file is read.
+    // The block is a view of one reused buffer that is overwritten once the
+    // callback returns, so memory stays bounded by the block size no matter
+    // how large the file is. The cache is never used or filled.
+    void StreamData(const std::vector<std::string> &select_columns,
+                    const Predicate &where, size_t block_rows,
+                    const BlockCallback &callback) const {
+        block_rows = std::max<size_t>(block_rows, 1);
+        csv::CSVReader reader(filepath, Projected(select_columns, where));
+        QueryPlan plan = Compile(reader.get_col_names(), select_columns, where);
+        Eigen::MatrixXd block(block_rows, plan.select.size());
+        Eigen::Index filled = 0;
+        for (csv::CSVRow &row : reader) {
+            if (!plan.where.Matches(row)) {
+                continue;
+            }
+            for (size_t c = 0; c < plan.select.size(); ++c) {
+                block(filled, c) =
+                    utils::ConvertField<double>(row[plan.select[c]]);
+            }
+            if (++filled == block.rows()) {
+                callback(block);
+                filled = 0;
+            }
+        }
+        if (filled > 0) {
+            callback(block.topRows(filled));
+        }
+    }
+
+    void StreamData(const std::vector<std::string> &select_columns,
+                    const std::unordered_map<std::string, std::string>
+                        &where_conditions,
+                    size_t block_rows, const BlockCallback &callback) const {
+        StreamData(select_columns, Predicate::FromConditions(where_conditions),
+                   block_rows, callback);
+    }
+
     virtual void WriteCSV(std::string const &filepath,
                           const std::vector<std::string> &columns) const {
         std::ofstream file(filepath.c_str());
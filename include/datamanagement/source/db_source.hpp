@@ -4,7 +4,7 @@
 // Created Date: Th Feb 2025                                                  //
 // Author: Matthew Carroll                                                    //
 // -----                                                                      //
-// Last Modified: Thu Feb 20 2025                                             //
+// Last Modified: Sat Oct 17 2026                                             //
 // Modified By: Matthew Carroll                                               //
 // -----                                                                      //
 // Copyright (c) 2025 Syndemics Lab at Boston Medical Center                  //
@@ -17,12 +17,26 @@
 #ifndef DATAMANAGEMENT_SOURCE_DBDATASOURCE_HPP_
 #define DATAMANAGEMENT_SOURCE_DBDATASOURCE_HPP_
 
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
 #include <SQLiteCpp/SQLiteCpp.h>
+#include <algorithm>
 #include <any>
+#include <datamanagement/utils/convert.hpp>
+#include <datamanagement/utils/matrix_builder.hpp>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <sqlite3.h>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -30,18 +44,245 @@ namespace datamanagement::source {
 using BindingVariant = std::variant<int, double, std::string>;
 class DBSource {
 private:
+    using CachedStatement =
+        std::pair<std::string, std::shared_ptr<SQLite::Statement>>;
+
+    // Prepared statements keyed by their SQL, most recently used first.
+    // They come before db so that move assignment finalizes the old
+    // statements before closing the old connection.
+    std::list<CachedStatement> statements = {};
+    std::unordered_map<std::string, std::list<CachedStatement>::iterator>
+        statement_index = {};
+    size_t statement_cache_size = DEFAULT_STATEMENT_CACHE_SIZE;
+
     std::unique_ptr<SQLite::Database> db = nullptr;
     std::string path = "";
 
+    // Resets a statement once a call is done with it, so a cached statement
+    // never keeps a read open or points at text bound in place between
+    // calls.
+    struct ResetOnExit {
+        SQLite::Statement &stmt;
+        ~ResetOnExit() {
+            stmt.tryReset();
+            stmt.clearBindings();
+        }
+    };
+
+    // A prepared statement for query with no bindings, taken from the cache
+    // when possible. A statement still in use by an outer call (a query
+    // issued from a Select callback) is never handed out twice; a fresh one
+    // is prepared instead.
+    std::shared_ptr<SQLite::Statement> Prepare(const std::string &query) {
+        auto found = statement_index.find(query);
+        if (found != statement_index.end()) {
+            statements.splice(statements.begin(), statements, found->second);
+            std::shared_ptr<SQLite::Statement> stmt = found->second->second;
+            if (stmt.use_count() > 2) {
+                return std::make_shared<SQLite::Statement>(*db, query);
+            }
+            stmt->tryReset();
+            stmt->clearBindings();
+            return stmt;
+        }
+        auto stmt = std::make_shared<SQLite::Statement>(*db, query);
+        statements.emplace_front(query, stmt);
+        statement_index[query] = statements.begin();
+        Evict();
+        return stmt;
+    }
+
+    // Binds one value, with the overload picked at compile time. Text is
+    // bound without a copy, so value has to outlive the statement's next
+    // step; every caller binds values that live until then.
+    template <typename T>
+    static void BindValue(SQLite::Statement &stmt, int index, const T &value) {
+        if constexpr (std::is_same_v<T, std::nullopt_t>) {
+            stmt.bind(index);
+        } else if constexpr (IsOptional<T>::value) {
+            if (value) {
+                BindValue(stmt, index, *value);
+            } else {
+                stmt.bind(index);
+            }
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            stmt.bindNoCopy(index, value);
+        } else if constexpr (std::is_convertible_v<T, const char *>) {
+            stmt.bindNoCopy(index, static_cast<const char *>(value));
+        } else if constexpr (std::is_same_v<T, bool>) {
+            stmt.bind(index, static_cast<int>(value));
+        } else if constexpr (std::is_integral_v<T>) {
+            if constexpr (sizeof(T) <= sizeof(int) && std::is_signed_v<T>) {
+                stmt.bind(index, static_cast<int>(value));
+            } else {
+                stmt.bind(index, static_cast<int64_t>(value));
+            }
+        } else {
+            static_assert(std::is_floating_point_v<T>,
+                          "Bindings can be arithmetic types, strings, "
+                          "std::nullopt and std::optional of those");
+            stmt.bind(index, static_cast<double>(value));
+        }
+    }
+
+    template <typename... Args>
+    static void BindAll(SQLite::Statement &stmt, const Args &...args) {
+        int index = 0;
+        (BindValue(stmt, ++index, args), ...);
+    }
+
+    // Runs query once per row in one transaction, with bind_row(stmt, i)
+    // binding the values of row i.
+    template <typename BindRow>
+    void RunBatch(const std::string &query, size_t rows,
+                  const BindRow &bind_row) {
+        try {
+            SQLite::Transaction transaction(*db);
+            std::shared_ptr<SQLite::Statement> stmt = Prepare(query);
+            ResetOnExit reset{*stmt};
+
+            for (size_t i = 0; i < rows; ++i) {
+                bind_row(*stmt, i);
+                stmt->exec();
+                stmt->reset();
+            }
+            transaction.commit();
+
+        } catch (const std::exception &e) {
+            throw std::runtime_error("Error executing query: " + query + "\n" +
+                                     e.what());
+        }
+    }
+
+    template <typename T> struct IsOptional : std::false_type {};
+    template <typename T>
+    struct IsOptional<std::optional<T>> : std::true_type {};
+
+    // Reads a result column as T, picking the accessor at compile time.
+    // std::optional<T> reads NULL as std::nullopt.
+    template <typename T> static T Decode(const SQLite::Column &column) {
+        if constexpr (IsOptional<T>::value) {
+            if (column.isNull()) {
+                return std::nullopt;
+            }
+            return Decode<typename T::value_type>(column);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return column.getString();
+        } else if constexpr (std::is_same_v<T, bool>) {
+            return column.getInt() != 0;
+        } else if constexpr (std::is_integral_v<T>) {
+            if constexpr (sizeof(T) <= sizeof(int) && std::is_signed_v<T>) {
+                return static_cast<T>(column.getInt());
+            } else {
+                return static_cast<T>(column.getInt64());
+            }
+        } else {
+            static_assert(std::is_floating_point_v<T>,
+                          "Select can decode arithmetic types, std::string "
+                          "and std::optional of those");
+            return static_cast<T>(column.getDouble());
+        }
+    }
+
+    // Reads column c of the current result row of stmt as a number. NULL
+    // reads as zero and text must hold a number in full, as a csv field
+    // must; other text and blobs throw.
+    static double ReadNumber(sqlite3_stmt *stmt, int c) {
+        switch (sqlite3_column_type(stmt, c)) {
+        case SQLITE_INTEGER:
+        case SQLITE_FLOAT:
+            return sqlite3_column_double(stmt, c);
+        case SQLITE_NULL:
+            return 0;
+        case SQLITE_TEXT: {
+            csv::string_view text(
+                reinterpret_cast<const char *>(sqlite3_column_text(stmt, c)),
+                sqlite3_column_bytes(stmt, c));
+            long double parsed = 0;
+            if (csv::internals::data_type(text, &parsed) >=
+                csv::DataType::CSV_INT8) {
+                return static_cast<double>(parsed);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        throw std::runtime_error("Column " +
+                                 std::string(sqlite3_column_name(stmt, c)) +
+                                 " does not hold a number");
+    }
+
+    // Runs query and calls read(stmt) for each result row, after checking
+    // the result has at least columns columns.
+    template <typename Read>
+    void ForEachRow(const std::string &query,
+                    const std::unordered_map<int, BindingVariant> &bindings,
+                    int columns, const Read &read) {
+        try {
+            std::shared_ptr<SQLite::Statement> stmt = Prepare(query);
+            ResetOnExit reset{*stmt};
+            Bind(*stmt, bindings);
+            if (stmt->getColumnCount() < columns) {
+                throw std::runtime_error(
+                    "Expected " + std::to_string(columns) +
+                    " columns, the query returns " +
+                    std::to_string(stmt->getColumnCount()));
+            }
+            while (stmt->executeStep()) {
+                read(*stmt);
+            }
+        } catch (const std::exception &e) {
+            throw std::runtime_error("Error executing query: " + query + "\n" +
+                                     e.what());
+        }
+    }
+
+    // identifier as a quoted SQL identifier. Backticks rather than double
+    // quotes, which SQLite reads as a string when no such column exists.
+    static std::string Quote(const std::string &identifier) {
+        std::string quoted = "`";
+        for (char ch : identifier) {
+            quoted += ch == '`' ? "``" : std::string(1, ch);
+        }
+        return quoted + "`";
+    }
+
+    // Finalizes the least recently used statements beyond the cache size.
+    // Callers still holding one keep it alive until they are done.
+    void Evict() {
+        while (statements.size() > statement_cache_size) {
+            statement_index.erase(statements.back().first);
+            statements.pop_back();
+        }
+    }
+
+    static void Bind(SQLite::Statement &stmt,
+                     const std::unordered_map<int, BindingVariant> &bindings) {
+        for (const auto &[index, value] : bindings) {
+            if (value.index() == 0) {
+                stmt.bind(index, std::get<int>(value));
+            } else if (value.index() == 1) {
+                stmt.bind(index, std::get<double>(value));
+            } else {
+                stmt.bind(index, std::get<std::string>(value));
+            }
+        }
+    }
+
 public:
+    static constexpr size_t DEFAULT_STATEMENT_CACHE_SIZE = 64;
+    static constexpr size_t DEFAULT_COMMIT_ROWS = 1 << 20;
+
     DBSource() {}
-    ~DBSource() = default;
+    ~DBSource() { ClearStatementCache(); }
 
     // Move Constructor
     DBSource(DBSource &&old) = default;
     DBSource &operator=(DBSource &&) = default;
 
     void ConnectToDatabase(const std::string &p) {
+        ClearStatementCache();
         path = p;
         db = std::make_unique<SQLite::Database>(p, SQLite::OPEN_READWRITE |
                                                        SQLite::OPEN_CREATE);
@@ -52,6 +293,23 @@ public:
         return p.stem();
     }
 
+    // Queries keep their prepared statement for reuse by later calls with
+    // the same SQL, skipping the parse and plan. Beyond size statements the
+    // least recently used is finalized; zero turns the cache off.
+    void SetStatementCacheSize(size_t size) {
+        statement_cache_size = size;
+        Evict();
+    }
+
+    size_t GetStatementCacheSize() const { return statement_cache_size; }
+
+    size_t CachedStatements() const { return statements.size(); }
+
+    void ClearStatementCache() {
+        statement_index.clear();
+        statements.clear();
+    }
+
     void
     Select(const std::string &query,
            std::function<void(std::any &storage, const SQLite::Statement &stmt)>
@@ -59,25 +317,153 @@ public:
            std::any &storage,
            const std::unordered_map<int, BindingVariant> &bindings = {}) {
         try {
-            SQLite::Statement stmt(*db, query);
+            std::shared_ptr<SQLite::Statement> stmt = Prepare(query);
+            ResetOnExit reset{*stmt};
+            Bind(*stmt, bindings);
 
-            for (const auto &[index, value] : bindings) {
-                if (value.index() == 0) {
-                    stmt.bind(index, std::get<int>(value));
-                } else if (value.index() == 1) {
-                    stmt.bind(index, std::get<double>(value));
-                } else {
-                    stmt.bind(index, std::get<std::string>(value));
+            SQLite::Transaction transaction(*db);
+
+            while (stmt->executeStep()) {
+                callback(storage, *stmt);
+            }
+
+            transaction.commit();
+        } catch (const std::exception &e) {
+            throw std::runtime_error("Error executing query: " + query + "\n" +
+                                     e.what());
+        }
+    }
+
+    // Runs query and decodes each result row into a tuple, column i as the
+    // i-th type, e.g. Select<int, std::string>("SELECT id, name FROM t;").
+    template <typename... Ts>
+    std::vector<std::tuple<Ts...>>
+    Select(const std::string &query,
+           const std::unordered_map<int, BindingVariant> &bindings = {}) {
+        static_assert(sizeof...(Ts) > 0, "Select needs the column types");
+        std::vector<std::tuple<Ts...>> rows;
+        ForEachRow(query, bindings, sizeof...(Ts),
+                   [&rows](const SQLite::Statement &stmt) {
+                       [&]<size_t... Is>(std::index_sequence<Is...>) {
+                           rows.emplace_back(Decode<Ts>(stmt.getColumn(Is))...);
+                       }(std::index_sequence_for<Ts...>());
+                   });
+        return rows;
+    }
+
+    // Runs query and decodes each result row into a Row, column i into the
+    // i-th member given, e.g.
+    // SelectInto<Person>("SELECT id, name FROM t;", {}, &Person::id,
+    //                    &Person::name).
+    template <typename Row, typename... Ts>
+    std::vector<Row>
+    SelectInto(const std::string &query,
+               const std::unordered_map<int, BindingVariant> &bindings,
+               Ts Row::*...fields) {
+        std::vector<Row> rows;
+        ForEachRow(query, bindings, sizeof...(Ts),
+                   [&rows, fields...](const SQLite::Statement &stmt) {
+                       Row &row = rows.emplace_back();
+                       [&]<size_t... Is>(std::index_sequence<Is...>) {
+                           ((row.*fields = Decode<Ts>(stmt.getColumn(Is))),
+                            ...);
+                       }(std::index_sequence_for<Ts...>());
+                   });
+        return rows;
+    }
+
+    // Runs query and returns its result as a matrix with one row per result
+    // row and one column per result column. Values are read straight from
+    // the statement into a growing column-major buffer; NULLs read as zero
+    // and text that is not a number throws. Integral types throw on
+    // fractions and overflow, as in CSVSource.
+    template <typename Scalar = double>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>
+    GetData(const std::string &query,
+            const std::unordered_map<int, BindingVariant> &bindings = {}) {
+        try {
+            std::shared_ptr<SQLite::Statement> stmt = Prepare(query);
+            ResetOnExit reset{*stmt};
+            Bind(*stmt, bindings);
+
+            sqlite3_stmt *raw = stmt->getPreparedStatement();
+            const int cols = stmt->getColumnCount();
+            utils::MatrixBuilder<Scalar> builder(cols);
+            while (stmt->executeStep()) {
+                builder.AddRow();
+                for (int c = 0; c < cols; ++c) {
+                    builder(c) =
+                        utils::ConvertValue<Scalar>(ReadNumber(raw, c));
                 }
             }
+            return builder.Finish();
+        } catch (const std::exception &e) {
+            throw std::runtime_error("Error executing query: " + query + "\n" +
+                                     e.what());
+        }
+    }
 
-            SQLite::Transaction transaction(*db);
+    // The select_columns of the rows of table whose where_conditions columns
+    // equal the given values, like CSVSource::GetData.
+    template <typename Scalar = double>
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>
+    GetData(const std::string &table,
+            const std::vector<std::string> &select_columns,
+            const std::unordered_map<std::string, std::string>
+                &where_conditions) {
+        if (select_columns.empty()) {
+            throw std::runtime_error("No columns selected from " + table);
+        }
+        std::string query = "SELECT ";
+        for (size_t i = 0; i < select_columns.size(); ++i) {
+            query += (i == 0 ? "" : ", ") + Quote(select_columns[i]);
+        }
+        query += " FROM " + Quote(table);
+
+        // Sorted so the same conditions always give the same SQL, and so
+        // the same cached statement
+        std::vector<std::pair<std::string, std::string>> conditions(
+            where_conditions.begin(), where_conditions.end());
+        std::sort(conditions.begin(), conditions.end());
+        std::unordered_map<int, BindingVariant> bindings;
+        for (size_t i = 0; i < conditions.size(); ++i) {
+            query += (i == 0 ? " WHERE " : " AND ") +
+                     Quote(conditions[i].first) + " = ?";
+            bindings[i + 1] = conditions[i].second;
+        }
+        return GetData<Scalar>(query + ";", bindings);
+    }
 
-            while (stmt.executeStep()) {
-                callback(storage, stmt);
+    // Runs query and returns its result as a sparse matrix with one row per
+    // result row and one column per result column. Only non-zero values are
+    // collected; cells are read and converted as in GetData.
+    template <typename Scalar = double>
+    Eigen::SparseMatrix<Scalar> GetSparseData(
+        const std::string &query,
+        const std::unordered_map<int, BindingVariant> &bindings = {}) {
+        try {
+            std::shared_ptr<SQLite::Statement> stmt = Prepare(query);
+            ResetOnExit reset{*stmt};
+            Bind(*stmt, bindings);
+
+            sqlite3_stmt *raw = stmt->getPreparedStatement();
+            std::vector<Eigen::Triplet<Scalar>> triplets;
+            Eigen::Index rows = 0;
+            const int cols = stmt->getColumnCount();
+            while (stmt->executeStep()) {
+                for (int c = 0; c < cols; ++c) {
+                    Scalar value =
+                        utils::ConvertValue<Scalar>(ReadNumber(raw, c));
+                    if (value != 0) {
+                        triplets.emplace_back(rows, c, value);
+                    }
+                }
+                ++rows;
             }
 
-            transaction.commit();
+            Eigen::SparseMatrix<Scalar> data(rows, cols);
+            data.setFromTriplets(triplets.begin(), triplets.end());
+            return data;
         } catch (const std::exception &e) {
             throw std::runtime_error("Error executing query: " + query + "\n" +
                                      e.what());
@@ -87,30 +473,146 @@ public:
     void BatchExecute(const std::string &query,
                       const std::vector<std::unordered_map<int, BindingVariant>>
                           &bindings_batch = {}) {
+        RunBatch(query, bindings_batch.size(),
+                 [&bindings_batch](SQLite::Statement &stmt, size_t i) {
+                     Bind(stmt, bindings_batch[i]);
+                 });
+    }
+
+    // Appends the rows of data to table, column c of data going to column
+    // columns[c]. Rows are written with multi-row INSERT statements holding
+    // as many rows as SQLite's variable limit allows, and committed every
+    // commit_rows rows (all in one transaction when zero), so a failure
+    // keeps the rows committed before it.
+    void BulkInsert(const std::string &table,
+                    const std::vector<std::string> &columns,
+                    const Eigen::Ref<const Eigen::MatrixXd> &data,
+                    size_t commit_rows = DEFAULT_COMMIT_ROWS) {
+        if (columns.empty() ||
+            columns.size() != static_cast<size_t>(data.cols())) {
+            throw std::runtime_error("Expected one column name per column "
+                                     "of data for " + table);
+        }
+        const size_t cols = columns.size();
+        const size_t rows = data.rows();
+        const size_t variables = sqlite3_limit(
+            db->getHandle(), SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+        const size_t chunk_rows = std::max<size_t>(variables / cols, 1);
+
+        std::string head = "INSERT INTO " + Quote(table) + " (";
+        std::string tuple = "(";
+        for (size_t c = 0; c < cols; ++c) {
+            head += (c == 0 ? "" : ", ") + Quote(columns[c]);
+            tuple += c == 0 ? "?" : ", ?";
+        }
+        head += ") VALUES ";
+        tuple += ")";
+        auto query_for = [&](size_t count) {
+            std::string query = head;
+            query.reserve(head.size() + count * (tuple.size() + 2));
+            for (size_t i = 0; i < count; ++i) {
+                query += (i == 0 ? "" : ", ") + tuple;
+            }
+            return query + ";";
+        };
+
+        std::string query = query_for(chunk_rows);
         try {
-            SQLite::Transaction transaction(*db);
-            SQLite::Statement stmt(*db, query);
-
-            for (auto &bindings : bindings_batch) {
-                for (const auto &[index, value] : bindings) {
-                    if (value.index() == 0) {
-                        stmt.bind(index, std::get<int>(value));
-                    } else if (value.index() == 1) {
-                        stmt.bind(index, std::get<double>(value));
-                    } else {
-                        stmt.bind(index, std::get<std::string>(value));
+            std::optional<SQLite::Transaction> transaction;
+            transaction.emplace(*db);
+            size_t uncommitted = 0;
+            for (size_t start = 0; start < rows; start += chunk_rows) {
+                size_t count = std::min(chunk_rows, rows - start);
+                // The shorter last statement differs in size from call to
+                // call, so it is kept out of the cache instead of evicting
+                // statements worth keeping.
+                std::shared_ptr<SQLite::Statement> stmt;
+                if (count == chunk_rows) {
+                    stmt = Prepare(query);
+                } else {
+                    query = query_for(count);
+                    stmt = std::make_shared<SQLite::Statement>(*db, query);
+                }
+                ResetOnExit reset{*stmt};
+                sqlite3_stmt *raw = stmt->getPreparedStatement();
+                int index = 0;
+                for (size_t r = start; r < start + count; ++r) {
+                    for (size_t c = 0; c < cols; ++c) {
+                        sqlite3_bind_double(raw, ++index, data(r, c));
                     }
                 }
-                stmt.exec();
-                stmt.reset();
+                stmt->exec();
+
+                uncommitted += count;
+                if (commit_rows > 0 && uncommitted >= commit_rows) {
+                    transaction->commit();
+                    transaction.emplace(*db);
+                    uncommitted = 0;
+                }
             }
-            transaction.commit();
+            transaction->commit();
+        } catch (const std::exception &e) {
+            // A full statement runs to many kilobytes, so only its start
+            throw std::runtime_error("Error executing query: " +
+                                     query.substr(0, 200) + "\n" + e.what());
+        }
+    }
 
+    // Runs query once with args bound to its parameters in order and
+    // returns the number of rows changed, e.g.
+    // Execute("UPDATE t SET age = ? WHERE name = ?;", 31, name).
+    template <typename... Args>
+    int Execute(const std::string &query, const Args &...args) {
+        try {
+            std::shared_ptr<SQLite::Statement> stmt = Prepare(query);
+            ResetOnExit reset{*stmt};
+            BindAll(*stmt, args...);
+            return stmt->exec();
         } catch (const std::exception &e) {
             throw std::runtime_error("Error executing query: " + query + "\n" +
                                      e.what());
         }
     }
+
+    // Runs query once per tuple in one transaction, binding the tuple's
+    // values to the parameters in order. Types are resolved at compile time
+    // and text is bound in place, so a row costs no allocation.
+    template <typename... Ts>
+    void BatchExecute(const std::string &query,
+                      std::span<const std::tuple<Ts...>> rows) {
+        RunBatch(query, rows.size(),
+                 [&rows](SQLite::Statement &stmt, size_t i) {
+                     std::apply(
+                         [&stmt](const Ts &...values) {
+                             BindAll(stmt, values...);
+                         },
+                         rows[i]);
+                 });
+    }
+
+    template <typename... Ts>
+    void BatchExecute(const std::string &query,
+                      const std::vector<std::tuple<Ts...>> &rows) {
+        BatchExecute(query, std::span<const std::tuple<Ts...>>(rows));
+    }
+
+    // Like BatchExecute, with the values held column by column: parameter
+    // k of row i is columns[k][i]. Each column is any sized, indexable
+    // container such as std::vector or std::span, all of the same size.
+    template <typename... Columns>
+    void BatchExecuteColumns(const std::string &query,
+                             const Columns &...columns) {
+        static_assert(sizeof...(Columns) > 0, "No columns to bind");
+        const size_t rows =
+            std::get<0>(std::forward_as_tuple(columns...)).size();
+        if (((columns.size() != rows) || ...)) {
+            throw std::runtime_error("Error executing query: " + query +
+                                     "\nColumns differ in length");
+        }
+        RunBatch(query, rows, [&](SQLite::Statement &stmt, size_t i) {
+            BindAll(stmt, columns[i]...);
+        });
+    }
 };
 } // namespace datamanagement::source
 
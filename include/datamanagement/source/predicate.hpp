@@ -0,0 +1,387 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: predicate.hpp                                                        //
+// Project: source                                                            //
+// Created Date: Sa Oct 2026                                                  //
+// Author: Matthew Carroll                                                    //
+// -----                                                                      //
+// Last Modified: Sat Oct 17 2026                                             //
+// Modified By: Matthew Carroll                                               //
+// -----                                                                      //
+// Copyright (c) 2026 Syndemics Lab at Boston Medical Center                  //
+// -----                                                                      //
+// HISTORY:                                                                   //
+// Date      	By	Comments                                                  //
+// ----------	---	--------------------------------------------------------- //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATAMANAGEMENT_SOURCE_PREDICATE_HPP_
+#define DATAMANAGEMENT_SOURCE_PREDICATE_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <datamanagement/utils/csv.hpp>
+#include <initializer_list>
+#include <limits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace datamanagement::source {
+// A filter over the columns of a table. Numeric comparisons work on parsed
+// doubles and never match a field that is not a number; text comparisons
+// work on the raw field. Predicates are built with the static factories and
+// combined with And/Or (or && and ||).
+class Predicate {
+public:
+    enum class Op {
+        ALL,
+        EQUAL,
+        NOT_EQUAL,
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        BETWEEN,
+        IN,
+        TEXT_EQUAL,
+        TEXT_IN,
+        AND,
+        OR
+    };
+
+private:
+    Op op;
+    std::string column = "";
+    double low = 0;
+    double high = 0;
+    std::vector<double> numbers = {};
+    std::vector<std::string> strings = {};
+    std::vector<Predicate> children = {};
+
+    Predicate(Op op) : op(op) {}
+
+    static Predicate Compare(Op op, const std::string &column, double value) {
+        Predicate predicate(op);
+        predicate.column = column;
+        predicate.low = value;
+        return predicate;
+    }
+
+    static Predicate Combine(Op op, std::vector<Predicate> predicates) {
+        Predicate predicate(op);
+        for (Predicate &child : predicates) {
+            if (child.op == op) {
+                for (Predicate &grandchild : child.children) {
+                    predicate.children.push_back(std::move(grandchild));
+                }
+            } else if (!(op == Op::AND && child.op == Op::ALL)) {
+                predicate.children.push_back(std::move(child));
+            }
+        }
+        return predicate;
+    }
+
+public:
+    // Matches every row.
+    static Predicate All() { return Predicate(Op::ALL); }
+
+    static Predicate Equal(const std::string &column, double value) {
+        return Compare(Op::EQUAL, column, value);
+    }
+    static Predicate NotEqual(const std::string &column, double value) {
+        return Compare(Op::NOT_EQUAL, column, value);
+    }
+    static Predicate Less(const std::string &column, double value) {
+        return Compare(Op::LESS, column, value);
+    }
+    static Predicate LessEqual(const std::string &column, double value) {
+        return Compare(Op::LESS_EQUAL, column, value);
+    }
+    static Predicate Greater(const std::string &column, double value) {
+        return Compare(Op::GREATER, column, value);
+    }
+    static Predicate GreaterEqual(const std::string &column, double value) {
+        return Compare(Op::GREATER_EQUAL, column, value);
+    }
+
+    // Inclusive on both ends.
+    static Predicate Between(const std::string &column, double low,
+                             double high) {
+        Predicate predicate = Compare(Op::BETWEEN, column, low);
+        predicate.high = high;
+        return predicate;
+    }
+
+    static Predicate In(const std::string &column,
+                        std::vector<double> values) {
+        Predicate predicate(Op::IN);
+        predicate.column = column;
+        predicate.numbers = std::move(values);
+        std::sort(predicate.numbers.begin(), predicate.numbers.end());
+        return predicate;
+    }
+
+    // Compares the field as text, so "35.0" does not match a field holding
+    // 35. Equal(column, double) compares numbers.
+    static Predicate Equal(const std::string &column,
+                           const std::string &value) {
+        Predicate predicate(Op::TEXT_EQUAL);
+        predicate.column = column;
+        predicate.strings = {value};
+        return predicate;
+    }
+
+    static Predicate In(const std::string &column,
+                        std::vector<std::string> values) {
+        Predicate predicate(Op::TEXT_IN);
+        predicate.column = column;
+        predicate.strings = std::move(values);
+        std::sort(predicate.strings.begin(), predicate.strings.end());
+        return predicate;
+    }
+
+    // Braced lists pick the overload by element type; without these two
+    // a pair of string literals would also fit the iterator pair
+    // constructor of std::vector<double>.
+    static Predicate In(const std::string &column,
+                        std::initializer_list<double> values) {
+        return In(column, std::vector<double>(values));
+    }
+    static Predicate In(const std::string &column,
+                        std::initializer_list<std::string> values) {
+        return In(column, std::vector<std::string>(values));
+    }
+
+    static Predicate And(std::vector<Predicate> predicates) {
+        return Combine(Op::AND, std::move(predicates));
+    }
+    static Predicate Or(std::vector<Predicate> predicates) {
+        return Combine(Op::OR, std::move(predicates));
+    }
+
+    // The text equality conditions GetData has always accepted, joined
+    // with And.
+    static Predicate
+    FromConditions(const std::unordered_map<std::string, std::string>
+                       &where_conditions) {
+        std::vector<Predicate> predicates;
+        for (const auto &[column, value] : where_conditions) {
+            predicates.push_back(Equal(column, value));
+        }
+        return And(std::move(predicates));
+    }
+
+    Op GetOp() const { return op; }
+    const std::string &GetColumn() const { return column; }
+    double GetLow() const { return low; }
+    double GetHigh() const { return high; }
+    const std::vector<double> &GetNumbers() const { return numbers; }
+    const std::vector<std::string> &GetStrings() const { return strings; }
+    const std::vector<Predicate> &GetChildren() const { return children; }
+
+    // Names of every column the predicate reads, in first use order.
+    std::vector<std::string> GetColumns() const {
+        std::vector<std::string> names;
+        CollectColumns(names);
+        return names;
+    }
+
+    void CollectColumns(std::vector<std::string> &names) const {
+        if (!column.empty() &&
+            std::find(names.begin(), names.end(), column) == names.end()) {
+            names.push_back(column);
+        }
+        for (const Predicate &child : children) {
+            child.CollectColumns(names);
+        }
+    }
+};
+
+inline Predicate operator&&(Predicate lhs, Predicate rhs) {
+    return Predicate::And({std::move(lhs), std::move(rhs)});
+}
+
+inline Predicate operator||(Predicate lhs, Predicate rhs) {
+    return Predicate::Or({std::move(lhs), std::move(rhs)});
+}
+
+// Reads a field as a double, or NaN when it is not a number.
+inline double ToNumber(csv::string_view text) {
+    double value = 0;
+    if (csv::internals::try_parse_double(text, value)) {
+        return value;
+    }
+    long double parsed = 0;
+    if (csv::internals::data_type(text, &parsed) < csv::DataType::CSV_INT8) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return static_cast<double>(parsed);
+}
+
+// A Predicate with its column names resolved to field indices. Evaluate
+// takes two accessors, number(index) returning a double (NaN when the field
+// is not a number) and text(index) returning a string_view, so the same
+// compiled form runs against csv rows and cached columns.
+class CompiledPredicate {
+private:
+    struct Node {
+        Predicate::Op op;
+        int column = -1;
+        double low = 0;
+        double high = 0;
+        std::vector<double> numbers = {};
+        std::vector<std::string> strings = {};
+        std::vector<Node> children = {};
+    };
+
+    Node root;
+
+    template <typename Number, typename Text>
+    static bool Evaluate(const Node &node, const Number &number,
+                         const Text &text) {
+        using Op = Predicate::Op;
+        switch (node.op) {
+        case Op::ALL:
+            return true;
+        case Op::AND:
+            for (const Node &child : node.children) {
+                if (!Evaluate(child, number, text)) {
+                    return false;
+                }
+            }
+            return true;
+        case Op::OR:
+            for (const Node &child : node.children) {
+                if (Evaluate(child, number, text)) {
+                    return true;
+                }
+            }
+            return false;
+        case Op::TEXT_EQUAL:
+            return text(node.column) == node.strings.front();
+        case Op::TEXT_IN:
+            return std::binary_search(node.strings.begin(), node.strings.end(),
+                                      text(node.column));
+        default:
+            break;
+        }
+
+        double value = number(node.column);
+        if (std::isnan(value)) {
+            return false;
+        }
+        switch (node.op) {
+        case Op::EQUAL:
+            return value == node.low;
+        case Op::NOT_EQUAL:
+            return value != node.low;
+        case Op::LESS:
+            return value < node.low;
+        case Op::LESS_EQUAL:
+            return value <= node.low;
+        case Op::GREATER:
+            return value > node.low;
+        case Op::GREATER_EQUAL:
+            return value >= node.low;
+        case Op::BETWEEN:
+            return node.low <= value && value <= node.high;
+        case Op::IN:
+            return std::binary_search(node.numbers.begin(), node.numbers.end(),
+                                      value);
+        default:
+            return false;
+        }
+    }
+
+    template <typename Resolve, typename Encode>
+    static Node Build(const Predicate &predicate, const Resolve &resolve,
+                      const Encode &encode) {
+        Node node{predicate.GetOp()};
+        node.low = predicate.GetLow();
+        node.high = predicate.GetHigh();
+        node.numbers = predicate.GetNumbers();
+        node.strings = predicate.GetStrings();
+        if (!predicate.GetColumn().empty()) {
+            node.column = resolve(predicate.GetColumn());
+        }
+        for (const Predicate &child : predicate.GetChildren()) {
+            node.children.push_back(Build(child, resolve, encode));
+        }
+
+        // Columns held as numbers or as dictionary codes are compared by the
+        // number each text value encodes to, so the scan never touches text.
+        bool text_op = node.op == Predicate::Op::TEXT_EQUAL ||
+                       node.op == Predicate::Op::TEXT_IN;
+        if (!text_op || node.column < 0) {
+            return node;
+        }
+        std::vector<double> numbers;
+        for (const std::string &value : node.strings) {
+            std::optional<double> number = encode(node.column, value);
+            if (!number) {
+                return node;
+            }
+            if (!std::isnan(*number)) {
+                numbers.push_back(*number);
+            }
+        }
+        std::sort(numbers.begin(), numbers.end());
+        node.op = Predicate::Op::IN;
+        node.numbers = std::move(numbers);
+        node.strings.clear();
+        return node;
+    }
+
+public:
+    // resolve maps a column name to its field index. encode(index, text)
+    // gives the number a text value stands for on a field that is read as a
+    // number (NaN when no row can hold it), or std::nullopt to keep
+    // comparing the field as text.
+    template <typename Resolve>
+    CompiledPredicate(const Predicate &predicate, const Resolve &resolve)
+        : CompiledPredicate(predicate, resolve,
+                            [](int, const std::string &) {
+                                return std::optional<double>();
+                            }) {}
+
+    template <typename Resolve, typename Encode>
+    CompiledPredicate(const Predicate &predicate, const Resolve &resolve,
+                      const Encode &encode)
+        : root(Build(predicate, resolve, encode)) {}
+
+    // Field indices the predicate reads, in first use order.
+    std::vector<int> GetColumns() const {
+        std::vector<int> columns;
+        std::vector<const Node *> pending = {&root};
+        while (!pending.empty()) {
+            const Node *node = pending.back();
+            pending.pop_back();
+            if (node->column >= 0 &&
+                std::find(columns.begin(), columns.end(), node->column) ==
+                    columns.end()) {
+                columns.push_back(node->column);
+            }
+            for (auto it = node->children.rbegin(); it != node->children.rend();
+                 ++it) {
+                pending.push_back(&*it);
+            }
+        }
+        return columns;
+    }
+
+    template <typename Number, typename Text>
+    bool Evaluate(const Number &number, const Text &text) const {
+        return Evaluate(root, number, text);
+    }
+
+    bool Matches(const csv::CSVRow &row) const {
+        return Evaluate(
+            [&row](int index) { return ToNumber(row[index].get_sv()); },
+            [&row](int index) { return row[index].get_sv(); });
+    }
+};
+} // namespace datamanagement::source
+
+#endif // DATAMANAGEMENT_SOURCE_PREDICATE_HPP_
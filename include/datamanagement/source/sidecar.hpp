@@ -0,0 +1,374 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: sidecar.hpp                                                          //
+// Project: source                                                            //
+// Created Date: Sa Oct 2026                                                  //
+// Author: Matthew Carroll                                                    //
+// -----                                                                      //
+// Last Modified: Sat Oct 17 2026                                             //
+// Modified By: Matthew Carroll                                               //
+// -----                                                                      //
+// Copyright (c) 2026 Syndemics Lab at Boston Medical Center                  //
+// -----                                                                      //
+// HISTORY:                                                                   //
+// Date      	By	Comments                                                  //
+// ----------	---	--------------------------------------------------------- //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATAMANAGEMENT_SOURCE_SIDECAR_HPP_
+#define DATAMANAGEMENT_SOURCE_SIDECAR_HPP_
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <datamanagement/source/column_table.hpp>
+#include <datamanagement/utils/csv.hpp>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace datamanagement::source {
+// A binary columnar copy of a ColumnTable written next to its csv file, so
+// later processes can memory map it instead of parsing text. The layout,
+// all little-endian, is
+//
+//   magic[8] version:u32 cols:u32 rows:u64 file_size:u64 mtime:i64 hash:u64
+//   path_length:u32 path
+//   cols x (flags:u8 name_length:u32 name)
+//   padding to 8 bytes
+//   for each numeric column: rows doubles
+//   for each column with text: (rows + 1) u64 offsets, the text, padding to 8
+//
+// where flags has NUMERIC set for numeric columns and TEXT set for columns
+// that store text: every text column, and numeric columns keeping their raw
+// text.
+//
+// A sidecar is used only when the csv still has the recorded size and
+// either the same path and mtime or, failing that, the same content hash.
+class Sidecar {
+private:
+    static constexpr char MAGIC[8] = {'D', 'M', 'C', 'O', 'L', 'S', '\r', '\n'};
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint8_t NUMERIC = 1;
+    static constexpr uint8_t TEXT = 2;
+
+    struct Entry {
+        std::string name;
+        uint8_t flags;
+        // Start of the doubles and of the text offsets
+        uint64_t values;
+        uint64_t text;
+    };
+
+    static bool HasText(const Column &column) {
+        return !column.numeric || column.text.Size() > 0;
+    }
+
+    std::shared_ptr<mio::mmap_source> mmap = nullptr;
+    std::vector<Entry> entries = {};
+    uint64_t rows = 0;
+
+    template <typename T> static void Put(std::ostream &out, T value) {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    static void Pad(std::ostream &out) {
+        static const char zeros[8] = {};
+        out.write(zeros, (8 - out.tellp() % 8) % 8);
+    }
+
+    // Reads a T at pos and advances it, or returns false past the end.
+    template <typename T>
+    bool Get(size_t &pos, T &value) const {
+        if (mmap->size() < sizeof(T) || pos > mmap->size() - sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, mmap->data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool GetString(size_t &pos, std::string &value) const {
+        uint32_t length = 0;
+        if (!Get(pos, length) || mmap->size() - pos < length) {
+            return false;
+        }
+        value.assign(mmap->data() + pos, length);
+        pos += length;
+        return true;
+    }
+
+    static int64_t Ticks(std::filesystem::file_time_type time) {
+        return static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    static std::string Canonical(const std::string &path) {
+        std::error_code ec;
+        std::filesystem::path canonical =
+            std::filesystem::weakly_canonical(path, ec);
+        return ec ? path : canonical.string();
+    }
+
+public:
+    ~Sidecar() = default;
+
+    static std::string PathFor(const std::string &csv_path) {
+        return csv_path + ".dmcache";
+    }
+
+    // 64 bit FNV-1a over the file taken a word at a time.
+    static uint64_t HashFile(const std::string &path) {
+        std::error_code error;
+        mio::mmap_source file = mio::make_mmap_source(path, error);
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        if (error) {
+            return hash;
+        }
+        size_t i = 0;
+        for (; i + 8 <= file.size(); i += 8) {
+            uint64_t word;
+            std::memcpy(&word, file.data() + i, 8);
+            hash = (hash ^ word) * 0x100000001b3ULL;
+        }
+        for (; i < file.size(); ++i) {
+            hash = (hash ^ static_cast<unsigned char>(file[i])) *
+                   0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    // Writes the sidecar for table, which was loaded from csv_path. The file
+    // is written under a temporary name and renamed into place so readers
+    // never see a partial sidecar. Returns false if it could not be written,
+    // or if csv_path no longer has the size and mtime the table recorded
+    // before parsing, as the hash would then not be of the parsed bytes.
+    static bool Write(const ColumnTable &table, const std::string &csv_path) {
+        if constexpr (std::endian::native != std::endian::little) {
+            return false;
+        }
+        auto unchanged = [&table, &csv_path]() {
+            std::error_code ec;
+            uintmax_t size = std::filesystem::file_size(csv_path, ec);
+            if (ec || size != table.GetFileSize()) {
+                return false;
+            }
+            auto modified = std::filesystem::last_write_time(csv_path, ec);
+            return !ec && modified == table.GetModifiedTime();
+        };
+        if (!unchanged()) {
+            return false;
+        }
+        uint64_t hash = HashFile(csv_path);
+        // A rewrite while hashing shows as a new size or mtime
+        if (!unchanged()) {
+            return false;
+        }
+        std::error_code ec;
+        std::string path = PathFor(csv_path);
+        std::string temp = path + "." + std::to_string(std::random_device()());
+        {
+            std::ofstream out(temp, std::ios::binary);
+            if (!out) {
+                return false;
+            }
+            const std::vector<Column> &columns = table.GetColumns();
+            out.write(MAGIC, sizeof(MAGIC));
+            Put<uint32_t>(out, VERSION);
+            Put<uint32_t>(out, columns.size());
+            Put<uint64_t>(out, table.Rows());
+            Put<uint64_t>(out, table.GetFileSize());
+            Put<int64_t>(out, Ticks(table.GetModifiedTime()));
+            Put<uint64_t>(out, hash);
+            std::string source = Canonical(csv_path);
+            Put<uint32_t>(out, source.size());
+            out.write(source.data(), source.size());
+            for (const Column &column : columns) {
+                Put<uint8_t>(out, (column.numeric ? NUMERIC : 0) |
+                                      (HasText(column) ? TEXT : 0));
+                Put<uint32_t>(out, column.name.size());
+                out.write(column.name.data(), column.name.size());
+            }
+            Pad(out);
+            for (const Column &column : columns) {
+                if (column.numeric) {
+                    out.write(
+                        reinterpret_cast<const char *>(column.values.Data()),
+                        column.values.Size() * sizeof(double));
+                }
+            }
+            for (const Column &column : columns) {
+                if (!HasText(column)) {
+                    continue;
+                }
+                const TextColumn &text = column.text;
+                out.write(reinterpret_cast<const char *>(text.Offsets()),
+                          (text.Size() + 1) * sizeof(uint64_t));
+                out.write(text.Bytes(), text.Offsets()[text.Size()]);
+                Pad(out);
+            }
+            if (!out) {
+                out.close();
+                std::filesystem::remove(temp, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(temp, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return false;
+        }
+        return true;
+    }
+
+    // Maps the sidecar of csv_path, or returns nullptr when it is missing,
+    // malformed or no longer describes the csv.
+    static std::shared_ptr<const Sidecar> Open(const std::string &csv_path) {
+        if constexpr (std::endian::native != std::endian::little) {
+            return nullptr;
+        }
+        std::error_code error;
+        auto sidecar = std::shared_ptr<Sidecar>(new Sidecar());
+        sidecar->mmap = std::make_shared<mio::mmap_source>(
+            mio::make_mmap_source(PathFor(csv_path), error));
+        if (error) {
+            return nullptr;
+        }
+
+        size_t pos = sizeof(MAGIC);
+        uint32_t version = 0, cols = 0;
+        uint64_t file_size = 0, hash = 0;
+        int64_t mtime = 0;
+        std::string source;
+        if (sidecar->mmap->size() < pos ||
+            std::memcmp(sidecar->mmap->data(), MAGIC, pos) != 0 ||
+            !sidecar->Get(pos, version) || version != VERSION ||
+            !sidecar->Get(pos, cols) || !sidecar->Get(pos, sidecar->rows) ||
+            !sidecar->Get(pos, file_size) || !sidecar->Get(pos, mtime) ||
+            !sidecar->Get(pos, hash) || !sidecar->GetString(pos, source)) {
+            return nullptr;
+        }
+
+        std::error_code ec;
+        if (std::filesystem::file_size(csv_path, ec) != file_size || ec) {
+            return nullptr;
+        }
+        auto modified = std::filesystem::last_write_time(csv_path, ec);
+        bool same_file = !ec && Ticks(modified) == mtime &&
+                         source == Canonical(csv_path);
+        if (!same_file && HashFile(csv_path) != hash) {
+            return nullptr;
+        }
+
+        for (uint32_t c = 0; c < cols; ++c) {
+            Entry entry;
+            if (!sidecar->Get(pos, entry.flags) ||
+                !sidecar->GetString(pos, entry.name) ||
+                !(entry.flags & (NUMERIC | TEXT))) {
+                return nullptr;
+            }
+            sidecar->entries.push_back(std::move(entry));
+        }
+        pos = (pos + 7) / 8 * 8;
+
+        const uint64_t size = sidecar->mmap->size();
+        const uint64_t rows = sidecar->rows;
+        for (Entry &entry : sidecar->entries) {
+            if (entry.flags & NUMERIC) {
+                entry.values = pos;
+                if ((size - std::min(pos, size)) / sizeof(double) < rows) {
+                    return nullptr;
+                }
+                pos += rows * sizeof(double);
+            }
+        }
+        for (Entry &entry : sidecar->entries) {
+            if (!(entry.flags & TEXT)) {
+                continue;
+            }
+            entry.text = pos;
+            if ((size - std::min(pos, size)) / sizeof(uint64_t) <= rows) {
+                return nullptr;
+            }
+            pos += rows * sizeof(uint64_t);
+            uint64_t length = 0;
+            if (!sidecar->Get(pos, length) || size - pos < length) {
+                return nullptr;
+            }
+            // The last offset is the length, so offsets that start at zero
+            // and never decrease keep every row inside the text.
+            const uint64_t *offsets = reinterpret_cast<const uint64_t *>(
+                sidecar->mmap->data() + entry.text);
+            if (offsets[0] != 0) {
+                return nullptr;
+            }
+            for (uint64_t r = 0; r < rows; ++r) {
+                if (offsets[r] > offsets[r + 1]) {
+                    return nullptr;
+                }
+            }
+            pos = (pos + length + 7) / 8 * 8;
+        }
+        return sidecar;
+    }
+
+    size_t Rows() const { return rows; }
+    size_t Cols() const { return entries.size(); }
+    const std::string &GetName(size_t col) const { return entries[col].name; }
+    bool IsNumeric(size_t col) const { return entries[col].flags & NUMERIC; }
+    bool HasText(size_t col) const { return entries[col].flags & TEXT; }
+
+    int IndexOf(const std::string &name) const {
+        for (size_t c = 0; c < entries.size(); ++c) {
+            if (entries[c].name == name) {
+                return static_cast<int>(c);
+            }
+        }
+        return csv::CSV_NOT_FOUND;
+    }
+
+    // The values of a numeric column, stored contiguously in the mapping.
+    const double *GetValues(size_t col) const {
+        return reinterpret_cast<const double *>(mmap->data() +
+                                                entries[col].values);
+    }
+
+    // Row offsets (rows + 1 of them) into the text of a column with text.
+    const uint64_t *GetOffsets(size_t col) const {
+        return reinterpret_cast<const uint64_t *>(mmap->data() +
+                                                  entries[col].text);
+    }
+
+    csv::string_view GetText(size_t col, size_t row) const {
+        const uint64_t *offsets = GetOffsets(col);
+        const char *text = reinterpret_cast<const char *>(offsets + rows + 1);
+        return csv::string_view(text + offsets[row],
+                                offsets[row + 1] - offsets[row]);
+    }
+
+    // A ColumnTable whose columns are views into the mapping, so nothing is
+    // parsed or copied up front. It goes stale with csv_path.
+    ColumnTable ToTable(const std::string &csv_path) const {
+        std::vector<Column> columns;
+        for (size_t c = 0; c < entries.size(); ++c) {
+            Column column{entries[c].name, IsNumeric(c)};
+            if (column.numeric) {
+                column.values = NumericColumn(GetValues(c), rows);
+            }
+            if (HasText(c)) {
+                const uint64_t *offsets = GetOffsets(c);
+                column.text = TextColumn(
+                    offsets, reinterpret_cast<const char *>(offsets + rows + 1),
+                    rows);
+            }
+            columns.push_back(std::move(column));
+        }
+        return ColumnTable(std::move(columns), rows,
+                           std::filesystem::file_size(csv_path),
+                           std::filesystem::last_write_time(csv_path), mmap);
+    }
+};
+} // namespace datamanagement::source
+
+#endif // DATAMANAGEMENT_SOURCE_SIDECAR_HPP_
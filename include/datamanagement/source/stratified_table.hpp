@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: stratified_table.hpp                                                 //
+// Project: source                                                            //
+// Created Date: Sa Oct 2026                                                  //
+// Author: Matthew Carroll                                                    //
+// -----                                                                      //
+// Last Modified: Sat Oct 17 2026                                             //
+// Modified By: Matthew Carroll                                               //
+// -----                                                                      //
+// Copyright (c) 2026 Syndemics Lab at Boston Medical Center                  //
+// -----                                                                      //
+// HISTORY:                                                                   //
+// Date      	By	Comments                                                  //
+// ----------	---	--------------------------------------------------------- //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef DATAMANAGEMENT_SOURCE_STRATIFIEDTABLE_HPP_
+#define DATAMANAGEMENT_SOURCE_STRATIFIEDTABLE_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace datamanagement::source {
+// A long format table pivoted into a dense array with one axis per
+// dimension column. Level i of dimension d is GetLevels(d)[i], and the
+// value of a stratum sits at the sum of index[d] * Strides()[d] in Data(),
+// with the last dimension varying fastest. Strata missing from the source
+// hold NaN.
+//
+// Labels are turned into level indices once with LevelIndex, outside any
+// hot loop, after which operator() is plain pointer arithmetic.
+class StratifiedTable {
+private:
+    std::vector<std::string> dimensions = {};
+    std::vector<std::vector<std::string>> levels = {};
+    std::vector<std::unordered_map<std::string, size_t>> level_index = {};
+    std::vector<size_t> shape = {};
+    std::vector<size_t> strides = {};
+    std::vector<double> values = {};
+
+public:
+    StratifiedTable() {}
+    // Every stratum starts as NaN; fill them through Data().
+    StratifiedTable(std::vector<std::string> dimensions,
+                    std::vector<std::vector<std::string>> levels)
+        : dimensions(std::move(dimensions)), levels(std::move(levels)) {
+        size_t size = 1;
+        shape.resize(this->levels.size());
+        strides.resize(this->levels.size());
+        level_index.resize(this->levels.size());
+        for (size_t d = this->levels.size(); d-- > 0;) {
+            shape[d] = this->levels[d].size();
+            strides[d] = size;
+            size *= shape[d];
+            for (size_t i = 0; i < shape[d]; ++i) {
+                level_index[d].emplace(this->levels[d][i], i);
+            }
+        }
+        values.assign(size, std::numeric_limits<double>::quiet_NaN());
+    }
+
+    size_t Dims() const { return dimensions.size(); }
+    size_t Size() const { return values.size(); }
+    const std::vector<std::string> &GetDimensions() const {
+        return dimensions;
+    }
+    const std::vector<std::string> &GetLevels(size_t dim) const {
+        return levels[dim];
+    }
+    const std::vector<size_t> &Shape() const { return shape; }
+    const std::vector<size_t> &Strides() const { return strides; }
+    const double *Data() const { return values.data(); }
+    double *Data() { return values.data(); }
+
+    // Index of a level of dimension dim, given as the text it has in the
+    // source (numbers in their shortest form, so 3.0 is "3").
+    size_t LevelIndex(size_t dim, const std::string &level) const {
+        auto it = level_index.at(dim).find(level);
+        if (it == level_index[dim].end()) {
+            throw std::runtime_error("Can't find " + level +
+                                     " in dimension " + dimensions[dim]);
+        }
+        return it->second;
+    }
+
+    // Position in Data() of the stratum with the given level indices.
+    template <typename... Index> size_t Offset(Index... index) const {
+        size_t offset = 0, d = 0;
+        ((offset += static_cast<size_t>(index) * strides[d++]), ...);
+        return offset;
+    }
+
+    // Value of the stratum with the given level indices, one per dimension.
+    // Indices are not checked; use At for checked lookups by label.
+    template <typename... Index> double operator()(Index... index) const {
+        return values[Offset(index...)];
+    }
+
+    double At(const std::vector<std::string> &labels) const {
+        if (labels.size() != Dims()) {
+            throw std::runtime_error("Expected " + std::to_string(Dims()) +
+                                     " levels, got " +
+                                     std::to_string(labels.size()));
+        }
+        size_t offset = 0;
+        for (size_t d = 0; d < labels.size(); ++d) {
+            offset += LevelIndex(d, labels[d]) * strides[d];
+        }
+        return values[offset];
+    }
+};
+} // namespace datamanagement::source
+
+#endif // DATAMANAGEMENT_SOURCE_STRATIFIEDTABLE_HPP_
@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: convert.hpp                                                          //
+// Project: utils                                                             //
+// Created Date: Sa Oct 2026                                                  //
+// Author: Matthew Carroll                                                    //
+// -----                                                                      //
+// Last Modified: Sat Oct 17 2026                                             //
+// Modified By: Matthew Carroll                                               //
+// -----                                                                      //
+// Copyright (c) 2026 Syndemics Lab at Boston Medical Center                  //
+// -----                                                                      //
+// HISTORY:                                                                   //
+// Date      	By	Comments                                                  //
+// ----------	---	--------------------------------------------------------- //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATAMANAGEMENT_UTILS_CONVERT_HPP_
+#define DATAMANAGEMENT_UTILS_CONVERT_HPP_
+
+#include <cmath>
+#include <datamanagement/utils/csv.hpp>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace datamanagement::utils {
+// Narrows an already parsed value to Scalar. Integral types only accept
+// whole numbers that fit.
+template <typename Scalar> Scalar ConvertValue(double value) {
+    static_assert(std::is_arithmetic_v<Scalar> &&
+                  !std::is_same_v<Scalar, bool>);
+    if constexpr (std::is_floating_point_v<Scalar>) {
+        return static_cast<Scalar>(value);
+    } else {
+        if (std::trunc(value) != value) {
+            throw std::runtime_error(csv::internals::ERROR_FLOAT_TO_INT);
+        }
+        if (value < static_cast<double>(std::numeric_limits<Scalar>::min()) ||
+            value >= std::ldexp(1.0, std::numeric_limits<Scalar>::digits)) {
+            throw std::runtime_error(csv::internals::ERROR_OVERFLOW);
+        }
+        return static_cast<Scalar>(value);
+    }
+}
+
+// Reads a csv field as Scalar by parsing it as a double and narrowing with
+// ConvertValue, so a field converts exactly as the cached table's value of
+// it does: "3.0" reads as the int 3. Floats are therefore rounded twice,
+// which can differ from a direct parse in the last bit.
+template <typename Scalar> Scalar ConvertField(csv::CSVField field) {
+    return ConvertValue<Scalar>(field.get<double>());
+}
+} // namespace datamanagement::utils
+
+#endif // DATAMANAGEMENT_UTILS_CONVERT_HPP_
@@ -5124,6 +5124,18 @@ namespace csv {
             return *this;
         }
 
+        /** Only record the fields of the named columns
+         *
+         *  @note The names are resolved against the header before the first
+         *        chunk is parsed, so every row of a file read by path is
+         *        projected. Unknown names are ignored.
+         *  @see  internals::IBasicCSVParser::set_projection()
+         */
+        CSVFormat &project(const std::vector<std::string> &columns) {
+            this->projected_columns = columns;
+            return *this;
+        }
+
         /** Tells the parser how to handle columns of a different length than
          * the others */
         CONSTEXPR_14 CSVFormat &variable_columns(
@@ -5199,6 +5211,9 @@ namespace csv {
         /**< Should be left empty unless file doesn't include header */
         std::vector<std::string> col_names = {};
 
+        /**< Names of the only columns to record, or empty for all */
+        std::vector<std::string> projected_columns = {};
+
         /**< Allow variable length columns? */
         VariableColumnPolicy variable_column_policy =
             VariableColumnPolicy::IGNORE_ROW;
@@ -5225,6 +5240,7 @@ namespace csv {
 
 #include <cassert>
 #include <cctype>
+#include <charconv>
 #include <cmath>
 #include <string>
 
@@ -5578,6 +5594,41 @@ namespace csv {
             // Just whitespace
             return DataType::CSV_NULL;
         }
+
+        /** Parse a plain decimal or scientific notation number into a double
+         *  which is correctly rounded, i.e. identical to `strtod`.
+         *
+         *  Surrounding spaces and a leading `+` are accepted. Returns false
+         *  for anything else `std::from_chars` would not consume entirely,
+         *  in which case callers should fall back to data_type().
+         */
+        inline bool try_parse_double(csv::string_view in,
+                                     double &out) noexcept {
+#ifdef __cpp_lib_to_chars
+            const char *first = in.data(), *last = in.data() + in.size();
+            while (first != last && *first == ' ')
+                first++;
+            while (last != first && *(last - 1) == ' ')
+                last--;
+            if (first != last && *first == '+')
+                first++;
+
+            // Reject forms data_type() considers strings, e.g. "inf" or "nan"
+            const char *lead = (first != last && *first == '-') ? first + 1
+                                                                : first;
+            if (lead == last ||
+                !(isdigit(static_cast<unsigned char>(*lead)) || *lead == '.'))
+                return false;
+
+            auto result =
+                std::from_chars(first, last, out, std::chars_format::general);
+            return result.ec == std::errc() && result.ptr == last;
+#else
+            (void)in;
+            (void)out;
+            return false;
+#endif
+        }
     } // namespace internals
 } // namespace csv
 
@@ -5708,6 +5759,11 @@ namespace csv {
             internals::ColNamesPtr col_names = nullptr;
             internals::ParseFlagMap parse_flags;
             internals::WhitespaceMap ws_flags;
+
+            /** When not empty, the ith slot gives where column i is stored
+             *  among a row's fields, or -1 if it was skipped while parsing
+             */
+            std::vector<int> projection = {};
         };
 
         using RawCSVDataPtr = std::shared_ptr<RawCSVData>;
@@ -6037,6 +6093,24 @@ namespace csv {
 
         return this->value;
     }
+
+    /** Retrieve this field's value as a double
+     *
+     *  Plain decimal values are converted directly with
+     *  internals::try_parse_double(), skipping the long double type
+     *  detection performed by the generic get(). Other values go through
+     *  the generic path.
+     */
+    template <> inline double CSVField::get<double>() {
+        double out = 0;
+        if (internals::try_parse_double(this->sv, out))
+            return out;
+
+        if (this->type() <= DataType::CSV_STRING)
+            throw std::runtime_error(internals::ERROR_NAN);
+
+        return static_cast<double>(this->value);
+    }
 #ifdef _MSC_VER
 #pragma endregion CSVField::get Specializations
 #endif
@@ -6059,6 +6133,12 @@ inline std::ostream &operator<<(std::ostream &os, csv::CSVField const &value) {
     return os;
 }
 
+#if (defined(__GNUC__) || defined(__clang__)) &&                               \
+    (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+#define CSV_HAS_X86_SIMD
+#endif
+
 namespace csv {
     namespace internals {
         /** Create a vector v where each index i corresponds to the
@@ -6227,6 +6307,117 @@ namespace csv {
     using RowCollection = internals::ThreadSafeDeque<CSVRow>;
 
     namespace internals {
+        /** Instruction sets which may be used to find the end of a run of
+         *  NOT_SPECIAL characters
+         *
+         *  AUTO picks the widest one supported by the running CPU. The other
+         *  values force a particular implementation, falling back to
+         *  narrower ones if unavailable, and mainly exist for testing.
+         */
+        enum class ScanMode { AUTO, SCALAR, SSE2, AVX2 };
+
+        /** Process wide scanner selection used by IBasicCSVParser */
+        inline ScanMode &scan_mode() noexcept {
+            static ScanMode mode = ScanMode::AUTO;
+            return mode;
+        }
+
+        /** Up to four characters that terminate a run of NOT_SPECIAL
+         * characters. Unused slots repeat the first character. */
+        using ScanNeedles = std::array<char, 4>;
+
+        /** Return the index of the first needle in data[pos, end), or end */
+        inline size_t scan_needles_scalar(const char *data, size_t pos,
+                                          size_t end,
+                                          const ScanNeedles &needles) noexcept {
+            for (; pos < end; pos++) {
+                const char ch = data[pos];
+                if (ch == needles[0] || ch == needles[1] ||
+                    ch == needles[2] || ch == needles[3])
+                    return pos;
+            }
+
+            return end;
+        }
+
+#ifdef CSV_HAS_X86_SIMD
+        /** Compare 16 bytes at a time against each needle */
+        inline size_t scan_needles_sse2(const char *data, size_t pos,
+                                        size_t end,
+                                        const ScanNeedles &needles) noexcept {
+            const __m128i n0 = _mm_set1_epi8(needles[0]);
+            const __m128i n1 = _mm_set1_epi8(needles[1]);
+            const __m128i n2 = _mm_set1_epi8(needles[2]);
+            const __m128i n3 = _mm_set1_epi8(needles[3]);
+
+            for (; pos + 16 <= end; pos += 16) {
+                const __m128i block =
+                    _mm_loadu_si128((const __m128i *)(data + pos));
+                const __m128i hits = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(block, n0),
+                                 _mm_cmpeq_epi8(block, n1)),
+                    _mm_or_si128(_mm_cmpeq_epi8(block, n2),
+                                 _mm_cmpeq_epi8(block, n3)));
+                const int mask = _mm_movemask_epi8(hits);
+                if (mask)
+                    return pos + __builtin_ctz((unsigned)mask);
+            }
+
+            return scan_needles_scalar(data, pos, end, needles);
+        }
+
+        /** Compare 32 bytes at a time against each needle */
+        __attribute__((target("avx2"))) inline size_t
+        scan_needles_avx2(const char *data, size_t pos, size_t end,
+                          const ScanNeedles &needles) noexcept {
+            const __m256i n0 = _mm256_set1_epi8(needles[0]);
+            const __m256i n1 = _mm256_set1_epi8(needles[1]);
+            const __m256i n2 = _mm256_set1_epi8(needles[2]);
+            const __m256i n3 = _mm256_set1_epi8(needles[3]);
+
+            for (; pos + 32 <= end; pos += 32) {
+                const __m256i block =
+                    _mm256_loadu_si256((const __m256i *)(data + pos));
+                const __m256i hits = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(block, n0),
+                                    _mm256_cmpeq_epi8(block, n1)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(block, n2),
+                                    _mm256_cmpeq_epi8(block, n3)));
+                const unsigned mask = (unsigned)_mm256_movemask_epi8(hits);
+                if (mask)
+                    return pos + __builtin_ctz(mask);
+            }
+
+            return scan_needles_sse2(data, pos, end, needles);
+        }
+
+        inline bool cpu_has_avx2() noexcept {
+            static const bool has_avx2 = __builtin_cpu_supports("avx2");
+            return has_avx2;
+        }
+#endif
+
+        /** Return the index of the first needle in data[pos, end), or end,
+         *  using the implementation selected by scan_mode()
+         */
+        inline size_t scan_needles(const char *data, size_t pos, size_t end,
+                                   const ScanNeedles &needles) noexcept {
+#ifdef CSV_HAS_X86_SIMD
+            switch (scan_mode()) {
+            case ScanMode::SCALAR:
+                return scan_needles_scalar(data, pos, end, needles);
+            case ScanMode::SSE2:
+                return scan_needles_sse2(data, pos, end, needles);
+            default:
+                if (cpu_has_avx2())
+                    return scan_needles_avx2(data, pos, end, needles);
+                return scan_needles_sse2(data, pos, end, needles);
+            }
+#else
+            return scan_needles_scalar(data, pos, end, needles);
+#endif
+        }
+
         /** Abstract base class which provides CSV parsing logic.
          *
          *  Concrete implementations may customize this logic across
@@ -6239,7 +6430,9 @@ namespace csv {
             IBasicCSVParser(const CSVFormat &, const ColNamesPtr &);
             IBasicCSVParser(const ParseFlagMap &parse_flags,
                             const WhitespaceMap &ws_flags)
-                : _parse_flags(parse_flags), _ws_flags(ws_flags) {};
+                : _parse_flags(parse_flags), _ws_flags(ws_flags) {
+                this->init_needles();
+            };
 
             virtual ~IBasicCSVParser() {}
 
@@ -6266,6 +6459,25 @@ namespace csv {
 
             void set_output(RowCollection &rows) { this->_records = &rows; }
 
+            /** Only record the fields of these columns in chunks parsed from
+             *  now on. Other fields are still scanned for delimiters and
+             *  quotes but never stored, and reading one throws.
+             */
+            void set_projection(const std::vector<size_t> &columns) {
+                this->_projection.clear();
+                for (size_t column : columns) {
+                    if (column >= this->_projection.size())
+                        this->_projection.resize(column + 1, -1);
+                    this->_projection[column] = 0;
+                }
+
+                int slot = 0;
+                for (int &value : this->_projection) {
+                    if (value == 0)
+                        value = slot++;
+                }
+            }
+
         protected:
             /** @name Current Parser State */
             ///@{
@@ -6312,6 +6524,21 @@ namespace csv {
             bool quote_escape = false;
             bool field_has_double_quote = false;
 
+            /** @name Vectorized Scanning */
+            ///@{
+            /** Whether the special characters fit in ScanNeedles */
+            bool use_needles = false;
+
+            /** Characters which end a field outside of quotes */
+            ScanNeedles field_needles = {};
+
+            /** Characters which end a field inside quotes */
+            ScanNeedles quote_needles = {};
+
+            /** Derive field_needles and quote_needles from _parse_flags */
+            void init_needles() noexcept;
+            ///@}
+
             /** Where we are in the current data block */
             size_t data_pos = 0;
 
@@ -6322,6 +6549,9 @@ namespace csv {
             /** Where complete rows should be pushed to */
             RowCollection *_records = nullptr;
 
+            /** @see set_projection() and RawCSVData::projection */
+            std::vector<int> _projection = {};
+
             CONSTEXPR_17 bool ws_flag(const char ch) const noexcept {
                 return _ws_flags.data()[ch + 128];
             }
@@ -6432,6 +6662,49 @@ namespace csv {
             std::string _filename;
             size_t mmap_pos = 0;
         };
+
+        /** Parser for a block of complete CSV rows that is already in memory
+         *
+         *  @par Implementation
+         *  The block is parsed in a single call to next() without copying.
+         *  `owner` keeps the memory backing `source` alive for as long as
+         *  any CSVRow produced from it exists. Used to parse independent
+         *  slices of one memory-mapped file on several threads at once.
+         */
+        class StringViewParser : public IBasicCSVParser {
+        public:
+            StringViewParser(csv::string_view source,
+                             std::shared_ptr<void> owner,
+                             const CSVFormat &format,
+                             const ColNamesPtr &col_names = nullptr)
+                : IBasicCSVParser(format, col_names), _source(source),
+                  _owner(std::move(owner)) {
+                this->source_size = source.size();
+            };
+
+            ~StringViewParser() {}
+
+            void next(size_t = ITERATION_CHUNK_SIZE) override {
+                if (this->eof())
+                    return;
+
+                this->field_start = UNINITIALIZED_FIELD;
+                this->field_length = 0;
+                this->reset_data_ptr();
+                this->data_ptr->_data = this->_owner;
+                this->data_ptr->data = this->_source;
+
+                this->current_row = CSVRow(this->data_ptr);
+                this->parse();
+
+                this->_eof = true;
+                this->end_feed();
+            }
+
+        private:
+            csv::string_view _source;
+            std::shared_ptr<void> _owner;
+        };
     } // namespace internals
 } // namespace csv
 
@@ -6446,6 +6719,8 @@ namespace csv {
         _get_col_names(csv::string_view head,
                        const CSVFormat format = CSVFormat::guess_csv());
 
+        std::string _head_rows(csv::string_view head, const CSVFormat &format);
+
         struct GuessScore {
             double score;
             size_t header;
@@ -6577,6 +6852,7 @@ namespace csv {
 
         /** Returns true if we have reached end of file */
         bool eof() const noexcept { return this->parser->eof(); };
+
         ///@}
 
         /** @name CSV Metadata */
@@ -7205,6 +7481,38 @@ namespace csv {
 
             _ws_flags = internals::make_ws_flags(format.trim_chars.data(),
                                                  format.trim_chars.size());
+            this->init_needles();
+        }
+
+        CSV_INLINE void IBasicCSVParser::init_needles() noexcept {
+            size_t n_field = 0, n_quote = 0;
+            this->use_needles = true;
+
+            for (int i = -128; i < 128; i++) {
+                const ParseFlags flag = this->parse_flag((char)i);
+                if (flag == ParseFlags::NOT_SPECIAL)
+                    continue;
+
+                if (n_field == this->field_needles.size()) {
+                    this->use_needles = false;
+                    return;
+                }
+
+                this->field_needles[n_field++] = (char)i;
+                if (quote_escape_flag(flag, true) != ParseFlags::NOT_SPECIAL)
+                    this->quote_needles[n_quote++] = (char)i;
+            }
+
+            // Pad unused slots with a character that is already a needle
+            for (; n_field < this->field_needles.size(); n_field++)
+                this->field_needles[n_field] = this->field_needles[0];
+
+            // Without a quote character, quote escaped mode is unreachable
+            if (n_quote == 0)
+                this->quote_needles = this->field_needles;
+
+            for (; n_quote && n_quote < this->quote_needles.size(); n_quote++)
+                this->quote_needles[n_quote] = this->quote_needles[0];
         }
 
         CSV_INLINE void IBasicCSVParser::end_feed() {
@@ -7241,9 +7549,16 @@ namespace csv {
             // Optimization: Since NOT_SPECIAL characters tend to occur in
             // contiguous sequences, use the loop below to avoid having to go
             // through the outer switch statement as much as possible
-            while (data_pos < in.size() &&
-                   compound_parse_flag(in[data_pos]) == ParseFlags::NOT_SPECIAL)
-                data_pos++;
+            if (this->use_needles && scan_mode() != ScanMode::SCALAR) {
+                data_pos = scan_needles(in.data(), data_pos, in.size(),
+                                        quote_escape ? this->quote_needles
+                                                     : this->field_needles);
+            } else {
+                while (data_pos < in.size() &&
+                       compound_parse_flag(in[data_pos]) ==
+                           ParseFlags::NOT_SPECIAL)
+                    data_pos++;
+            }
 
             field_length = data_pos - (field_start + current_row_start());
 
@@ -7255,8 +7570,13 @@ namespace csv {
         }
 
         CSV_INLINE void IBasicCSVParser::push_field() {
-            // Update
-            if (field_has_double_quote) {
+            const auto &projection = this->data_ptr->projection;
+            if (!projection.empty() &&
+                (current_row.row_length >= projection.size() ||
+                 projection[current_row.row_length] < 0)) {
+                // Column is not projected => only count it
+                field_has_double_quote = false;
+            } else if (field_has_double_quote) {
                 fields->emplace_back(field_start == UNINITIALIZED_FIELD
                                          ? 0
                                          : (unsigned int)field_start,
@@ -7365,7 +7685,10 @@ namespace csv {
         }
 
         CSV_INLINE void IBasicCSVParser::push_row() {
-            current_row.row_length = fields->size() - current_row.fields_start;
+            // With a projection row_length counts skipped fields as well
+            if (this->data_ptr->projection.empty())
+                current_row.row_length =
+                    fields->size() - current_row.fields_start;
             this->_records->push_back(std::move(current_row));
         }
 
@@ -7373,6 +7696,7 @@ namespace csv {
             this->data_ptr = std::make_shared<RawCSVData>();
             this->data_ptr->parse_flags = this->_parse_flags;
             this->data_ptr->col_names = this->_col_names;
+            this->data_ptr->projection = this->_projection;
             this->fields = &(this->data_ptr->fields);
         }
 
@@ -7595,9 +7919,42 @@ namespace csv {
             parser.set_output(rows);
             parser.next();
 
+            if (format.get_header() < 0 ||
+                rows.size() <= (size_t)format.get_header())
+                throw std::runtime_error("Cannot find the header row.");
             return CSVRow(std::move(rows[format.get_header()]));
         }
 
+        /** Return the rows of head up to and including the header row, so
+         *  reading the column names does not parse the whole head
+         *
+         *  Records are counted as the parser counts them: a run of '\r' and
+         *  '\n' outside quotes ends one record, so blank lines do not add
+         *  rows. Any quote toggles the quoted state, which can only end the
+         *  cut later than the parser would, never earlier.
+         *
+         *  @param[in] head    Text at the start of a CSV file
+         *  @param[in] format  Format of the CSV file
+         */
+        CSV_INLINE std::string _head_rows(csv::string_view head,
+                                          const CSVFormat &format) {
+            auto newline = [](char c) { return c == '\r' || c == '\n'; };
+            bool quoted = false;
+            int rows = 0;
+            for (size_t i = 0; i < head.size(); i++) {
+                if (format.is_quoting_enabled() &&
+                    head[i] == format.get_quote_char()) {
+                    quoted = !quoted;
+                } else if (!quoted && newline(head[i])) {
+                    while (i + 1 < head.size() && newline(head[i + 1]))
+                        i++;
+                    if (rows++ == format.get_header())
+                        return std::string(head.substr(0, i + 1));
+                }
+            }
+            return std::string(head);
+        }
+
         CSV_INLINE GuessScore calculate_score(csv::string_view head,
                                               const CSVFormat &format) {
             // Frequency counter of row length
@@ -7730,8 +8087,25 @@ namespace csv {
         if (!format.col_names.empty())
             this->set_col_names(format.col_names);
 
+        /** A projection needs the column names before the first chunk is
+         *  parsed, so read them from the header rows of head */
+        std::vector<size_t> projection;
+        if (!format.projected_columns.empty()) {
+            if (this->col_names->empty() && format.header >= 0) {
+                this->set_col_names(internals::_get_col_names(
+                    internals::_head_rows(head, format), format));
+            }
+            for (const std::string &name : format.projected_columns) {
+                int index = this->col_names->index_of(name);
+                if (index != CSV_NOT_FOUND)
+                    projection.push_back((size_t)index);
+            }
+        }
+
         this->parser = std::unique_ptr<Parser>(
             new Parser(filename, format, this->col_names)); // For C++11
+        if (!projection.empty())
+            this->parser->set_projection(projection);
         this->initial_read();
     }
 
@@ -8020,7 +8394,16 @@ namespace csv {
         if (index >= this->size())
             throw std::runtime_error("Index out of bounds.");
 
-        const size_t field_index = this->fields_start + index;
+        size_t slot = index;
+        const auto &projection = this->data->projection;
+        if (!projection.empty()) {
+            if (index >= projection.size() || projection[index] < 0)
+                throw std::runtime_error("Column " + std::to_string(index) +
+                                         " was not projected.");
+            slot = (size_t)projection[index];
+        }
+
+        const size_t field_index = this->fields_start + slot;
         auto &field = this->data->fields[field_index];
         auto field_str = csv::string_view(this->data->data)
                              .substr(this->data_start + field.start);
@@ -0,0 +1,111 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: matrix_builder.hpp                                                   //
+// Project: utils                                                             //
+// Created Date: Sa Oct 2026                                                  //
+// Author: Matthew Carroll                                                    //
+// -----                                                                      //
+// Last Modified: Sat Oct 17 2026                                             //
+// Modified By: Matthew Carroll                                               //
+// -----                                                                      //
+// Copyright (c) 2026 Syndemics Lab at Boston Medical Center                  //
+// -----                                                                      //
+// HISTORY:                                                                   //
+// Date      	By	Comments                                                  //
+// ----------	---	--------------------------------------------------------- //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATAMANAGEMENT_UTILS_MATRIXBUILDER_HPP_
+#define DATAMANAGEMENT_UTILS_MATRIXBUILDER_HPP_
+
+#include <Eigen/Core>
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace datamanagement::utils {
+// Collects rows of unknown count into fixed size column-major blocks, so
+// growing never copies earlier rows. Finish() copies each block's columns
+// into the result with memcpy and frees the block straight away, keeping
+// peak memory close to the size of the final matrix.
+template <typename Scalar = double> class MatrixBuilder {
+public:
+    using Matrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+
+private:
+    struct Block {
+        std::unique_ptr<Scalar[]> data;
+        size_t capacity;
+        size_t rows;
+    };
+
+    size_t cols;
+    size_t block_rows;
+    size_t rows = 0;
+    std::vector<Block> blocks = {};
+
+public:
+    static constexpr size_t MIN_BLOCK_ROWS = 1 << 8;
+    static constexpr size_t DEFAULT_BLOCK_ROWS = 1 << 16;
+
+    MatrixBuilder(size_t cols, size_t block_rows = DEFAULT_BLOCK_ROWS)
+        : cols(cols), block_rows(std::max(block_rows, MIN_BLOCK_ROWS)) {}
+    ~MatrixBuilder() = default;
+
+    MatrixBuilder(MatrixBuilder &&) = default;
+    MatrixBuilder &operator=(MatrixBuilder &&) = default;
+
+    size_t Rows() const { return rows; }
+    size_t Cols() const { return cols; }
+
+    // Starts a new row whose values are then written with operator().
+    void AddRow() {
+        if (blocks.empty() || blocks.back().rows == blocks.back().capacity) {
+            // Blocks grow with the row count so small results stay small
+            size_t capacity = std::clamp<size_t>(rows, MIN_BLOCK_ROWS,
+                                                 block_rows);
+            blocks.push_back(
+                {std::unique_ptr<Scalar[]>(new Scalar[capacity * cols]),
+                 capacity, 0});
+        }
+        ++blocks.back().rows;
+        ++rows;
+    }
+
+    // Value of column col in the row most recently started by AddRow().
+    Scalar &operator()(size_t col) {
+        Block &block = blocks.back();
+        return block.data[col * block.capacity + block.rows - 1];
+    }
+
+    // Moves the rows of other after the rows of this builder.
+    void Append(MatrixBuilder &&other) {
+        for (Block &block : other.blocks) {
+            blocks.push_back(std::move(block));
+        }
+        rows += other.rows;
+        other.blocks.clear();
+        other.rows = 0;
+    }
+
+    Matrix Finish() {
+        Matrix data(rows, cols);
+        Eigen::Index offset = 0;
+        for (Block &block : blocks) {
+            for (size_t c = 0; c < cols; ++c) {
+                std::memcpy(data.col(c).data() + offset,
+                            block.data.get() + c * block.capacity,
+                            block.rows * sizeof(Scalar));
+            }
+            offset += block.rows;
+            block.data.reset();
+        }
+        blocks.clear();
+        rows = 0;
+        return data;
+    }
+};
+} // namespace datamanagement::utils
+
+#endif // DATAMANAGEMENT_UTILS_MATRIXBUILDER_HPP_
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: thread_pool.hpp                                                      //
+// Project: utils                                                             //
+// Created Date: Sa Oct 2026                                                  //
+// Author: Matthew Carroll                                                    //
+// -----                                                                      //
+// Last Modified: Sat Oct 17 2026                                             //
+// Modified By: Matthew Carroll                                               //
+// -----                                                                      //
+// Copyright (c) 2026 Syndemics Lab at Boston Medical Center                  //
+// -----                                                                      //
+// HISTORY:                                                                   //
+// Date      	By	Comments                                                  //
+// ----------	---	--------------------------------------------------------- //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DATAMANAGEMENT_UTILS_THREADPOOL_HPP_
+#define DATAMANAGEMENT_UTILS_THREADPOOL_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace datamanagement::utils {
+class ThreadPool {
+private:
+    std::vector<std::thread> workers = {};
+    std::queue<std::function<void()>> tasks = {};
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+    void Work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock,
+                               [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+public:
+    ThreadPool(size_t threads = std::thread::hardware_concurrency()) {
+        threads = std::max<size_t>(threads, 1);
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back(&ThreadPool::Work, this);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t Size() const { return workers.size(); }
+
+    // Exceptions thrown by the task are rethrown from the returned future.
+    template <typename F>
+    std::future<std::invoke_result_t<F>> Submit(F &&task) {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(
+            std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([packaged]() { (*packaged)(); });
+        }
+        condition.notify_one();
+        return result;
+    }
+};
+} // namespace datamanagement::utils
+
+#endif // DATAMANAGEMENT_UTILS_THREADPOOL_HPP_
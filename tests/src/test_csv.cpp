@@ -0,0 +1,222 @@
+////////////////////////////////////////////////////////////////////////////////
+// File: test_csv.cpp                                                         //
+// Project: src                                                               //
+// Created Date: Sa Oct 2026                                                  //
+// Author: Matthew Carroll                                                    //
+// -----                                                                      //
+// Last Modified: Sat Oct 17 2026                                             //
+// Modified By: Matthew Carroll                                               //
+// -----                                                                      //
+// Copyright (c) 2026 Syndemics Lab at Boston Medical Center                  //
+// -----                                                                      //
+// HISTORY:                                                                   //
+// Date      	By	Comments                                                  //
+// ----------	---	--------------------------------------------------------- //
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <datamanagement/utils/csv.hpp>
+#include <gtest/gtest.h>
+
+using Rows = std::vector<std::vector<std::string>>;
+
+class CSVParserTest : public ::testing::Test {
+protected:
+    std::vector<std::string> corpus = {};
+
+    void SetUp() override {
+        corpus = {
+            "a,b,c\n1,2,3\n4,5,6\n",
+            "a,b,c\r\n1,2,3\r\n4,5,6",
+            "a,b\n\"quoted, comma\",\"line\nbreak\"\n\"esc \"\"q\"\"\",x\n",
+            "a,b\n,\n\"\",\"\"\n,last\n",
+            "a,b\n\n\n1,2\n\r\n3,4\n",
+            "a|b|c\n1|\"2|3\"|4\n",
+            "a\tb\n\xc3\xa9t\xc3\xa9\t\x80\xff\n",
+            "h1,h2\n" + std::string(40, 'x') + "," + std::string(70, 'y') +
+                "\n" + std::string(15, 'z') + ",\"" + std::string(33, ',') +
+                "\"\n",
+            "a,b\nunterminated,\"quote\n",
+            "a,b\n  padded  ,  \"  quoted  \"  \n",
+        };
+
+        std::mt19937 gen(42);
+        const std::string alphabet = "abc,,\"\"\n\r 0123456789.-\t|xyzABC";
+        for (int n = 0; n < 50; ++n) {
+            std::string text = "c0,c1,c2,c3\n";
+            std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+            std::uniform_int_distribution<size_t> length(0, 4000);
+            size_t len = length(gen);
+            for (size_t i = 0; i < len; ++i) {
+                text += alphabet[pick(gen)];
+            }
+            corpus.push_back(text);
+        }
+    }
+
+    void TearDown() override {
+        csv::internals::scan_mode() = csv::internals::ScanMode::AUTO;
+    }
+
+    Rows Parse(const std::string &text, csv::CSVFormat format) {
+        Rows rows;
+        csv::CSVReader reader = csv::parse(text, format);
+        rows.push_back(reader.get_col_names());
+        for (csv::CSVRow &row : reader) {
+            rows.push_back(row);
+        }
+        return rows;
+    }
+};
+
+TEST_F(CSVParserTest, VectorizedScanMatchesScalar) {
+    std::vector<csv::CSVFormat> formats(3, csv::CSVFormat());
+    formats[1].trim({' ', '\t'}).variable_columns(true);
+    formats[2].delimiter('|').quote(false);
+
+    for (csv::CSVFormat &format : formats) {
+        for (const std::string &text : corpus) {
+            csv::internals::scan_mode() = csv::internals::ScanMode::SCALAR;
+            Rows expected = Parse(text, format);
+
+            csv::internals::scan_mode() = csv::internals::ScanMode::SSE2;
+            EXPECT_EQ(Parse(text, format), expected) << text;
+
+            csv::internals::scan_mode() = csv::internals::ScanMode::AVX2;
+            EXPECT_EQ(Parse(text, format), expected) << text;
+        }
+    }
+}
+
+TEST_F(CSVParserTest, ProjectionMatchesFullParse) {
+    auto parse = [](const std::string &text,
+                    const std::vector<size_t> &projection) {
+        csv::RowCollection rows;
+        csv::internals::StringViewParser parser(text, nullptr,
+                                                csv::CSVFormat());
+        parser.set_projection(projection);
+        parser.set_output(rows);
+        parser.next();
+        std::vector<csv::CSVRow> result;
+        while (!rows.empty()) {
+            result.push_back(rows.pop_front());
+        }
+        return result;
+    };
+
+    for (const std::string &text : corpus) {
+        std::vector<csv::CSVRow> full = parse(text, {});
+        std::vector<csv::CSVRow> projected = parse(text, {3, 1});
+        ASSERT_EQ(projected.size(), full.size()) << text;
+        for (size_t r = 0; r < full.size(); ++r) {
+            ASSERT_EQ(projected[r].size(), full[r].size()) << text;
+            for (size_t c : {1, 3}) {
+                if (c < full[r].size()) {
+                    EXPECT_EQ(projected[r][c].get_sv(), full[r][c].get_sv());
+                }
+            }
+            if (!full[r].empty()) {
+                EXPECT_THROW(projected[r][0].get_sv(), std::runtime_error);
+            }
+        }
+    }
+}
+
+TEST_F(CSVParserTest, FormatProjectsFirstChunk) {
+    const char *path = "projected.csv";
+    std::FILE *file = std::fopen(path, "w");
+    std::fputs("\"a\nx\",b,c\n1,2,3\n\"4\",\"5,5\",6\n", file);
+    std::fclose(file);
+
+    csv::CSVReader reader(path,
+                          csv::CSVFormat().project({"c", "a\nx", "missing"}));
+    EXPECT_EQ(reader.get_col_names(),
+              std::vector<std::string>({"a\nx", "b", "c"}));
+    std::vector<csv::CSVRow> rows(reader.begin(), reader.end());
+    ASSERT_EQ(rows.size(), 2);
+    EXPECT_EQ(rows[0]["c"].get_sv(), "3");
+    EXPECT_EQ(rows[1][0].get_sv(), "4");
+    EXPECT_EQ(rows[1][2].get_sv(), "6");
+    EXPECT_THROW(rows[0]["b"].get_sv(), std::runtime_error);
+    EXPECT_THROW(rows[1][1].get_sv(), std::runtime_error);
+    std::remove(path);
+}
+
+TEST_F(CSVParserTest, FormatProjectsAfterBlankLines) {
+    const char *path = "blank_lines.csv";
+    for (const char *text :
+         {"\n\na,b\n1,2\n3,4\n", "\r\n\r\na,b\r\n1,2\r\n3,4\r\n"}) {
+        std::FILE *file = std::fopen(path, "w");
+        std::fputs(text, file);
+        std::fclose(file);
+
+        csv::CSVReader reader(path, csv::CSVFormat::guess_csv().project({"b"}));
+        EXPECT_EQ(reader.get_col_names(), std::vector<std::string>({"a", "b"}));
+        std::vector<std::string> values;
+        for (csv::CSVRow &row : reader) {
+            values.emplace_back(row["b"].get_sv());
+        }
+        EXPECT_EQ(values, std::vector<std::string>({"2", "4"}));
+    }
+    std::remove(path);
+}
+
+TEST_F(CSVParserTest, ScanNeedles) {
+    std::string text(100, 'x');
+    text[37] = ',';
+    text[70] = '\n';
+    const char *data = text.data();
+    csv::internals::ScanNeedles needles = {',', '\n', '"', '\r'};
+
+    for (auto mode : {csv::internals::ScanMode::SCALAR,
+                      csv::internals::ScanMode::SSE2,
+                      csv::internals::ScanMode::AVX2}) {
+        csv::internals::scan_mode() = mode;
+        EXPECT_EQ(csv::internals::scan_needles(data, 0, text.size(), needles),
+                  37);
+        EXPECT_EQ(csv::internals::scan_needles(data, 38, text.size(), needles),
+                  70);
+        EXPECT_EQ(csv::internals::scan_needles(data, 71, text.size(), needles),
+                  100);
+        EXPECT_EQ(csv::internals::scan_needles(data, 0, 37, needles), 37);
+    }
+}
+
+TEST_F(CSVParserTest, GetDoubleMatchesStrtod) {
+    std::vector<std::string> values = {
+        "0",      "-0",     "0.1",     "  12.5 ", "+3",
+        "1e-320", "1E308",  "-2.5e-3", ".5",      "5.",
+        "123456789012345678901234567890", "0.30000000000000004"};
+
+    std::mt19937_64 gen(7);
+    std::uniform_real_distribution<double> uniform(-1e6, 1e6);
+    std::uniform_int_distribution<int> exponent(-300, 300);
+    char buffer[64];
+    for (int i = 0; i < 20000; ++i) {
+        double x = uniform(gen) * std::pow(10.0, exponent(gen) / 10);
+        const char *format = (i % 3 == 0)   ? "%.17g"
+                             : (i % 3 == 1) ? "%.6f"
+                                            : "%.12e";
+        std::snprintf(buffer, sizeof(buffer), format, x);
+        values.push_back(buffer);
+    }
+
+    for (const std::string &value : values) {
+        double expected = std::strtod(value.c_str(), nullptr);
+        EXPECT_EQ(csv::CSVField(value).get<double>(), expected) << value;
+    }
+
+    EXPECT_THROW(csv::CSVField("inf").get<double>(), std::runtime_error);
+    EXPECT_THROW(csv::CSVField("1e").get<double>(), std::runtime_error);
+    EXPECT_THROW(csv::CSVField("").get<double>(), std::runtime_error);
+    EXPECT_THROW(csv::CSVField("\xe9" "5").get<double>(), std::runtime_error);
+    EXPECT_THROW(csv::CSVField("-\xc3\xa9").get<double>(),
+                 std::runtime_error);
+    EXPECT_EQ(csv::CSVField("- 5").get<double>(), -5);
+}
@@ -50,6 +50,28 @@ TEST_F(CSVSourceTest, GetData) {
     EXPECT_EQ(filtered_data.cols(), 2);
 }
 
+TEST_F(CSVSourceTest, GetDataUnknownColumns) {
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("test.csv");
+
+    for (bool caching : {false, true}) {
+        csv_source.SetCaching(caching);
+        try {
+            csv_source.GetData({"id", "height"}, {{"city", "Boston"}});
+            FAIL() << "Expected std::runtime_error";
+        } catch (const std::runtime_error &e) {
+            std::string message = e.what();
+            EXPECT_NE(message.find("height"), std::string::npos);
+            EXPECT_NE(message.find("city"), std::string::npos);
+        }
+
+        Eigen::MatrixXd data =
+            csv_source.GetData({"age"}, {{"name", "Charlie"}});
+        ASSERT_EQ(data.rows(), 1);
+        EXPECT_EQ(data(0, 0), 35);
+    }
+}
+
 TEST_F(CSVSourceTest, WriteCSV) {
     datamanagement::source::CSVSource csv_source1;
     csv_source1.ConnectToFile("test.csv");
@@ -63,4 +85,505 @@ TEST_F(CSVSourceTest, WriteCSV) {
     Eigen::MatrixXd data2 = csv_source2.GetData({"id", "age"}, {});
     ASSERT_TRUE(data2.isApprox(data1));
     std::remove("output.csv");
-}
\ No newline at end of file
+}
+
+TEST_F(CSVSourceTest, GetDataCached) {
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("test.csv");
+    Eigen::MatrixXd expected = csv_source.GetData({"id", "age"}, {});
+    Eigen::MatrixXd expected_filtered =
+        csv_source.GetData({"age"}, {{"name", "Bob"}});
+
+    csv_source.SetCaching(true);
+    EXPECT_TRUE(csv_source.GetData({"id", "age"}, {}).isApprox(expected));
+    EXPECT_TRUE(csv_source.GetData({"age"}, {{"name", "Bob"}})
+                    .isApprox(expected_filtered));
+    EXPECT_EQ(csv_source.GetData({"id"}, {{"age", "35"}})(0, 0), 3);
+    EXPECT_EQ(csv_source.GetTable().Rows(), 3);
+    EXPECT_THROW(csv_source.GetData({"missing"}, {}), std::runtime_error);
+}
+
+TEST_F(CSVSourceTest, GetDataCachedRebuildsStaleCache) {
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("test.csv");
+    csv_source.SetCaching(true);
+    EXPECT_EQ(csv_source.GetData({"id"}, {}).rows(), 3);
+
+    std::ofstream file("test.csv", std::ios::app);
+    file << "4,Dana,40\n";
+    file.close();
+
+    Eigen::MatrixXd data = csv_source.GetData({"id", "age"}, {});
+    EXPECT_EQ(data.rows(), 4);
+    EXPECT_EQ(data(3, 1), 40);
+}
+
+TEST_F(CSVSourceTest, GetDataCachedConcurrently) {
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("test.csv");
+    Eigen::MatrixXd expected = csv_source.GetData({"id", "age"}, {});
+
+    datamanagement::utils::ThreadPool pool(4);
+    csv_source.Prefetch(pool);
+    std::vector<std::future<Eigen::MatrixXd>> reads;
+    for (int i = 0; i < 8; ++i) {
+        reads.push_back(pool.Submit(
+            [&csv_source]() { return csv_source.GetData({"id", "age"}, {}); }));
+    }
+    for (auto &read : reads) {
+        EXPECT_TRUE(read.get() == expected);
+    }
+    EXPECT_FALSE(csv_source.IsPrefetching());
+}
+
+TEST_F(CSVSourceTest, GetDataParallel) {
+    std::ofstream file("parallel.csv");
+    file << "id,name,age\n";
+    for (int i = 0; i < 2000; ++i) {
+        file << i << ",";
+        if (i % 3 == 0) {
+            file << "\"Last, First\nLine \"\"" << i << "\"\"\"";
+        } else {
+            file << "Name" << i % 5;
+        }
+        file << "," << i % 90 << (i % 7 == 0 ? "\r\n" : "\n");
+    }
+    file.close();
+
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("parallel.csv");
+    Eigen::MatrixXd expected = csv_source.GetData({"age", "id"}, {});
+    Eigen::MatrixXd expected_filtered =
+        csv_source.GetData({"id"}, {{"name", "Name1"}});
+
+    csv_source.SetThreads(4);
+    Eigen::MatrixXd data = csv_source.GetData({"age", "id"}, {});
+    EXPECT_EQ(data.rows(), 2000);
+    EXPECT_TRUE(data == expected);
+    EXPECT_TRUE(csv_source.GetData({"id"}, {{"name", "Name1"}}) ==
+                expected_filtered);
+    std::remove("parallel.csv");
+}
+
+TEST_F(CSVSourceTest, GetDataPredicate) {
+    using datamanagement::source::Predicate;
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("test.csv");
+
+    Predicate where = (Predicate::Between("age", 26, 40) &&
+                       Predicate::In("name", {"Alice", "Bob", "Charlie"})) ||
+                      Predicate::Equal("id", 2);
+    for (size_t threads : {1, 2}) {
+        for (bool caching : {false, true}) {
+            csv_source.SetThreads(threads);
+            csv_source.SetCaching(caching);
+            Eigen::MatrixXd data = csv_source.GetData({"id"}, where);
+            ASSERT_EQ(data.rows(), 3);
+            EXPECT_EQ(csv_source.GetData({"id"}, Predicate::Less("age", 30))
+                          .rows(),
+                      1);
+            EXPECT_EQ(csv_source
+                          .GetData({"id"}, Predicate::GreaterEqual("name", 0))
+                          .rows(),
+                      0);
+            Predicate in_list =
+                Predicate::In("id", {1, 3}) && Predicate::NotEqual("age", 30);
+            EXPECT_EQ(csv_source.GetData({"age"}, in_list)(0, 0), 35);
+        }
+    }
+}
+
+TEST_F(CSVSourceTest, GetDataIndexed) {
+    using datamanagement::source::Predicate;
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("test.csv");
+    csv_source.AddIndex("name");
+    csv_source.AddIndex("age");
+    // Checked against the header before the table is built
+    EXPECT_THROW(csv_source.AddIndex("height"), std::runtime_error);
+    EXPECT_TRUE(csv_source.IsCaching());
+    EXPECT_TRUE(csv_source.GetTable().HasIndex("name"));
+    // and by the cached table after, neither recording the name
+    EXPECT_THROW(csv_source.AddIndex("height"), std::runtime_error);
+    EXPECT_EQ(csv_source.GetIndexes(),
+              std::vector<std::string>({"name", "age"}));
+    EXPECT_TRUE(csv_source.GetTable().HasIndex("age"));
+
+    EXPECT_EQ(csv_source.GetData({"id"}, {{"name", "Bob"}})(0, 0), 2);
+    EXPECT_EQ(csv_source.GetData({"id"}, {{"age", "35"}})(0, 0), 3);
+    EXPECT_EQ(csv_source.GetData({"id"}, {{"age", "35.0"}}).rows(), 0);
+    EXPECT_EQ(csv_source.GetData({"id"}, {{"name", "Dana"}}).rows(), 0);
+    Predicate where = Predicate::In("age", {25, 30, 99}) &&
+                      Predicate::In("name", {"Alice", "Charlie"});
+    EXPECT_EQ(csv_source.GetData({"id"}, where).rows(), 1);
+
+    std::ofstream file("test.csv", std::ios::app);
+    file << "4,Bob,40\n";
+    file.close();
+    EXPECT_EQ(csv_source.GetData({"id"}, {{"name", "Bob"}}).rows(), 2);
+
+    // Rebuilds skip indexed columns the file no longer has
+    std::ofstream rewritten("test.csv");
+    rewritten << "id,name\n5,Bob\n";
+    rewritten.close();
+    EXPECT_EQ(csv_source.GetData({"id"}, {{"name", "Bob"}})(0, 0), 5);
+}
+
+TEST_F(CSVSourceTest, GetDataWhereCachedMatchesUncached) {
+    std::ofstream file("mixed.csv");
+    file << "id,code,age\n";
+    file << "1,7,30\n";
+    file << "2,x,35\n";
+    file << "3,7.0,35.0\n";
+    file << "4,07,40\n";
+    file.close();
+
+    std::vector<std::unordered_map<std::string, std::string>> conditions = {
+        {{"age", "35"}},  {{"age", "35.0"}}, {{"age", "abc"}},
+        {{"code", "7"}},  {{"code", "7.0"}}, {{"code", "x"}},
+        {{"code", "07"}}, {{"code", "7"}, {"age", "35"}},
+        {{"id", "1"}},    {{"id", "01"}},    {{"id", "1.0"}}};
+
+    namespace source = datamanagement::source;
+    source::CSVSource writer;
+    writer.ConnectToFile("mixed.csv");
+    writer.SetSidecar(true);
+    writer.GetData({"id"}, {});
+
+    source::CSVSource serial, threaded, cached, indexed, categorical, mapped;
+    for (auto *source :
+         {&serial, &threaded, &cached, &indexed, &categorical, &mapped}) {
+        source->ConnectToFile("mixed.csv");
+    }
+    mapped.SetSidecar(true);
+    threaded.SetThreads(2);
+    cached.SetCaching(true);
+    indexed.AddIndex("code");
+    indexed.AddIndex("age");
+    categorical.AddCategorical("code");
+
+    for (const auto &where : conditions) {
+        Eigen::MatrixXd expected = serial.GetData({"id"}, where);
+        EXPECT_TRUE(threaded.GetData({"id"}, where) == expected);
+        EXPECT_TRUE(cached.GetData({"id"}, where) == expected);
+        EXPECT_TRUE(indexed.GetData({"id"}, where) == expected);
+        EXPECT_TRUE(categorical.GetData({"id"}, where) == expected);
+        EXPECT_TRUE(mapped.GetData({"id"}, where) == expected);
+    }
+    EXPECT_EQ(serial.GetData({"id"}, {{"age", "35.0"}})(0, 0), 3);
+    EXPECT_EQ(serial.GetData({"id"}, {{"code", "7"}}).rows(), 1);
+    EXPECT_EQ(serial.GetData({"id"}, {{"id", "01"}}).rows(), 0);
+    EXPECT_EQ(cached.GetData({"id"}, source::Predicate::Equal("age", 35))
+                  .rows(),
+              2);
+    std::remove("mixed.csv");
+    std::remove(source::Sidecar::PathFor("mixed.csv").c_str());
+}
+
+TEST_F(CSVSourceTest, StreamData) {
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("test.csv");
+
+    std::vector<Eigen::Index> block_sizes;
+    Eigen::MatrixXd streamed(0, 2);
+    csv_source.StreamData(
+        {"id", "age"}, {}, 2,
+        [&](const Eigen::Ref<const Eigen::MatrixXd> &block) {
+            block_sizes.push_back(block.rows());
+            streamed.conservativeResize(streamed.rows() + block.rows(),
+                                        Eigen::NoChange);
+            streamed.bottomRows(block.rows()) = block;
+        });
+    EXPECT_EQ(block_sizes, std::vector<Eigen::Index>({2, 1}));
+    EXPECT_TRUE(streamed == csv_source.GetData({"id", "age"}, {}));
+
+    double total = 0;
+    csv_source.StreamData(
+        {"age"}, {{"name", "Bob"}}, 10,
+        [&](const Eigen::Ref<const Eigen::MatrixXd> &block) {
+            total += block.sum();
+        });
+    EXPECT_EQ(total, 25);
+}
+
+TEST_F(CSVSourceTest, GetDataSidecar) {
+    namespace source = datamanagement::source;
+    std::string sidecar = source::Sidecar::PathFor("test.csv");
+    std::remove(sidecar.c_str());
+
+    source::CSVSource writer;
+    writer.ConnectToFile("test.csv");
+    writer.SetSidecar(true);
+    Eigen::MatrixXd expected = writer.GetData({"id", "age"}, {});
+    ASSERT_TRUE(std::filesystem::exists(sidecar));
+
+    auto stored = source::Sidecar::Open("test.csv");
+    ASSERT_NE(stored, nullptr);
+    EXPECT_EQ(stored->Rows(), 3);
+    EXPECT_FALSE(stored->IsNumeric(stored->IndexOf("name")));
+    EXPECT_EQ(stored->GetText(stored->IndexOf("name"), 2), "Charlie");
+    EXPECT_EQ(stored->GetValues(stored->IndexOf("age"))[1], 25);
+
+    source::CSVSource reader;
+    reader.ConnectToFile("test.csv");
+    reader.SetSidecar(true);
+    EXPECT_TRUE(reader.GetData({"id", "age"}, {}) == expected);
+    EXPECT_EQ(reader.GetData({"id"}, {{"name", "Bob"}})(0, 0), 2);
+
+    // A new mtime alone is accepted through the content hash
+    std::filesystem::last_write_time(
+        "test.csv", std::filesystem::last_write_time("test.csv") +
+                        std::chrono::hours(1));
+    EXPECT_NE(source::Sidecar::Open("test.csv"), nullptr);
+
+    std::ofstream file("test.csv", std::ios::app);
+    file << "4,Dana,40\n";
+    file.close();
+    EXPECT_EQ(source::Sidecar::Open("test.csv"), nullptr);
+    EXPECT_EQ(reader.GetData({"id"}, {}).rows(), 4);
+    EXPECT_NE(source::Sidecar::Open("test.csv"), nullptr);
+
+    // A csv touched after it was parsed gets no sidecar for that parse
+    source::ColumnTable table = source::ColumnTable::Load("test.csv");
+    std::filesystem::last_write_time(
+        "test.csv", table.GetModifiedTime() + std::chrono::hours(1));
+    EXPECT_FALSE(source::Sidecar::Write(table, "test.csv"));
+    ASSERT_NE(source::Sidecar::Open("test.csv"), nullptr);
+
+    // Text offsets running past the text are rejected
+    std::ifstream in(sidecar, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)),
+                      std::istreambuf_iterator<char>());
+    in.close();
+    size_t text = bytes.find("AliceBobCharlieDana");
+    ASSERT_NE(text, std::string::npos);
+    uint64_t offset = 100;
+    std::memcpy(&bytes[text - 4 * sizeof(uint64_t)], &offset, sizeof(offset));
+    std::ofstream out(sidecar, std::ios::binary);
+    out << bytes;
+    out.close();
+    EXPECT_EQ(source::Sidecar::Open("test.csv"), nullptr);
+    std::remove(sidecar.c_str());
+}
+
+TEST_F(CSVSourceTest, MapData) {
+    namespace source = datamanagement::source;
+    std::ofstream file("mapped.csv");
+    file << "id,name,age,weight\n";
+    file << "1,Alice,30,60.5\n";
+    file << "2,Bob,25,72.25\n";
+    file.close();
+
+    source::CSVSource writer;
+    writer.ConnectToFile("mapped.csv");
+    writer.SetSidecar(true);
+    Eigen::MatrixXd expected = writer.GetData({"age", "weight"}, {});
+
+    source::CSVSource reader;
+    reader.ConnectToFile("mapped.csv");
+    reader.SetSidecar(true);
+    Eigen::Map<const Eigen::MatrixXd> mapped =
+        reader.MapData({"age", "weight"});
+    EXPECT_TRUE(mapped == expected);
+    EXPECT_EQ(reader.MapColumn("id")(1), 2);
+    EXPECT_EQ(reader.MapData({"id", "age", "weight"}).cols(), 3);
+    EXPECT_THROW(reader.MapData({"weight", "age"}), std::runtime_error);
+    EXPECT_THROW(reader.MapColumn("name"), std::runtime_error);
+
+    std::remove(source::Sidecar::PathFor("mapped.csv").c_str());
+    std::remove("mapped.csv");
+}
+
+TEST_F(CSVSourceTest, GetDataScalar) {
+    std::ofstream file("whole.csv");
+    file << "whole,fraction\n";
+    file << "3.0,2.5\n";
+    file.close();
+
+    datamanagement::source::CSVSource csv_source, whole_source;
+    csv_source.ConnectToFile("test.csv");
+    whole_source.ConnectToFile("whole.csv");
+
+    for (size_t threads : {1, 2}) {
+        for (bool caching : {false, true}) {
+            csv_source.SetThreads(threads);
+            csv_source.SetCaching(caching);
+            whole_source.SetThreads(threads);
+            whole_source.SetCaching(caching);
+            EXPECT_EQ(whole_source.GetData<int>({"whole"}, {})(0, 0), 3);
+            EXPECT_THROW(whole_source.GetData<int>({"fraction"}, {}),
+                         std::runtime_error);
+            Eigen::MatrixXi ids = csv_source.GetData<int>({"id", "age"}, {});
+            EXPECT_EQ(ids(2, 1), 35);
+            Eigen::MatrixXf ages =
+                csv_source.GetData<float>({"age"}, {{"name", "Bob"}});
+            EXPECT_EQ(ages(0, 0), 25.0f);
+            EXPECT_THROW(csv_source.GetData<int>({"name"}, {}),
+                         std::runtime_error);
+        }
+    }
+    std::remove("whole.csv");
+}
+
+TEST_F(CSVSourceTest, GetSparseData) {
+    std::ofstream file("sparse.csv");
+    file << "from,to,rate\n";
+    for (int i = 0; i < 50; ++i) {
+        file << (i % 10 == 0 ? i : 0) << ",0," << (i == 7 ? 0.5 : 0) << "\n";
+    }
+    file.close();
+
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("sparse.csv");
+    Eigen::MatrixXd dense = csv_source.GetData({"from", "to", "rate"}, {});
+    for (bool caching : {false, true}) {
+        csv_source.SetCaching(caching);
+        Eigen::SparseMatrix<double> sparse =
+            csv_source.GetSparseData({"from", "to", "rate"}, {});
+        EXPECT_EQ(sparse.nonZeros(), 5);
+        EXPECT_TRUE(Eigen::MatrixXd(sparse) == dense);
+        EXPECT_EQ(csv_source.GetSparseData<int>({"from"}, {{"to", "0"}})
+                      .nonZeros(),
+                  4);
+    }
+    std::remove("sparse.csv");
+}
+
+TEST_F(CSVSourceTest, Aggregate) {
+    namespace source = datamanagement::source;
+    std::ofstream file("grouped.csv");
+    file << "sex,age_group,value\n";
+    file << "M,1,2\nF,1,4\nM,2,6\nM,1,8\nF,1,10\n";
+    file.close();
+
+    source::CSVSource csv_source;
+    csv_source.ConnectToFile("grouped.csv");
+    for (bool caching : {false, true}) {
+        csv_source.SetCaching(caching);
+        source::GroupedData sums = csv_source.Aggregate(
+            {"sex", "age_group"}, {"value"}, source::Aggregation::SUM);
+        ASSERT_EQ(sums.keys.size(), 3);
+        EXPECT_EQ(sums.keys[0], std::vector<std::string>({"M", "1"}));
+        EXPECT_EQ(sums.keys[1], std::vector<std::string>({"F", "1"}));
+        EXPECT_EQ(sums.values(0, 0), 10);
+        EXPECT_EQ(sums.values(1, 0), 14);
+        EXPECT_EQ(sums.values(2, 0), 6);
+
+        source::GroupedData means = csv_source.Aggregate(
+            {"sex"}, {"value", "age_group"}, source::Aggregation::MEAN,
+            source::Predicate::Less("value", 10));
+        EXPECT_EQ(means.values(0, 0), 16.0 / 3);
+        EXPECT_EQ(means.values(1, 0), 4);
+        EXPECT_EQ(means.values(1, 1), 1);
+
+        EXPECT_EQ(csv_source
+                      .Aggregate({"sex"}, {"value"}, source::Aggregation::MAX)
+                      .values(1, 0),
+                  10);
+        source::GroupedData counts =
+            csv_source.Aggregate({}, {}, source::Aggregation::COUNT);
+        EXPECT_EQ(counts.values(0, 0), 5);
+    }
+    std::remove("grouped.csv");
+}
+
+TEST_F(CSVSourceTest, GetDataCategorical) {
+    using datamanagement::source::Predicate;
+    std::ofstream file("test.csv", std::ios::app);
+    file << "4,Bob,40\n";
+    file.close();
+
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("test.csv");
+    csv_source.AddCategorical("name");
+    csv_source.AddCategorical("age");
+    EXPECT_THROW(csv_source.AddCategorical("city"), std::runtime_error);
+    EXPECT_EQ(csv_source.GetCategoricals(),
+              std::vector<std::string>({"name", "age"}));
+    EXPECT_TRUE(csv_source.IsCaching());
+    EXPECT_TRUE(csv_source.GetTable().IsCategorical("name"));
+    EXPECT_FALSE(csv_source.GetTable().IsCategorical("age"));
+
+    Eigen::MatrixXi codes = csv_source.GetData<int>({"id", "name"}, {});
+    Eigen::MatrixXi expected(4, 2);
+    expected << 1, 0, 2, 1, 3, 2, 4, 1;
+    EXPECT_EQ(codes, expected);
+    EXPECT_EQ(csv_source.GetCategories("name"),
+              std::vector<std::string>({"Alice", "Bob", "Charlie"}));
+
+    EXPECT_EQ(csv_source.GetData({"id"}, {{"name", "Bob"}}).rows(), 2);
+    EXPECT_EQ(csv_source.GetData({"id"}, {{"name", "Dana"}}).rows(), 0);
+    Eigen::MatrixXd in = csv_source.GetData(
+        {"id"}, Predicate::In("name", {"Alice", "Charlie", "Dana"}));
+    EXPECT_EQ(in, Eigen::Vector2d(1, 3));
+    EXPECT_EQ(csv_source.GetData({"id"}, Predicate::Equal("name", 2)).rows(),
+              1);
+    EXPECT_THROW(csv_source.GetCategories("age"), std::runtime_error);
+}
+
+TEST_F(CSVSourceTest, Stratify) {
+    std::ofstream file("params.csv");
+    file << "age_group,sex,oud,value\n";
+    file << "20,f,Active,0.1\n";
+    file << "10,f,Active,0.2\n";
+    file << "20,m,Active,0.3\n";
+    file << "10,m,Nonactive,0.4\n";
+    file << "20,f,Nonactive,0.5\n";
+    file.close();
+
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("params.csv");
+    datamanagement::source::StratifiedTable table =
+        csv_source.Stratify({"age_group", "sex", "oud"}, "value");
+    EXPECT_EQ(table.Shape(), std::vector<size_t>({2, 2, 2}));
+    EXPECT_EQ(table.Strides(), std::vector<size_t>({4, 2, 1}));
+    EXPECT_EQ(table.GetLevels(0), std::vector<std::string>({"10", "20"}));
+    EXPECT_EQ(table.GetLevels(2),
+              std::vector<std::string>({"Active", "Nonactive"}));
+
+    size_t m = table.LevelIndex(1, "m");
+    size_t nonactive = table.LevelIndex(2, "Nonactive");
+    EXPECT_EQ(table(0, m, nonactive), 0.4);
+    EXPECT_EQ(table(1, 0, nonactive), 0.5);
+    EXPECT_EQ(table.Data()[table.Offset(1, m, 0)], 0.3);
+    EXPECT_EQ(table.At({"10", "f", "Active"}), 0.2);
+    EXPECT_TRUE(std::isnan(table.At({"10", "m", "Active"})));
+    EXPECT_THROW(table.At({"30", "m", "Active"}), std::runtime_error);
+
+    EXPECT_THROW(csv_source.Stratify({"age_group", "sex"}, "value"),
+                 std::runtime_error);
+    std::remove("params.csv");
+}
+
+TEST_F(CSVSourceTest, GetSchema) {
+    std::ofstream file("schema.csv");
+    file << "id;name;score;note\n";
+    file << "1;Alice;3;\n";
+    file << "2;Bob;4.5;\n";
+    file << "3;Charlie;5;x\n";
+    file << "4;Dana;6;";
+    file.close();
+
+    datamanagement::source::CSVSource csv_source;
+    csv_source.ConnectToFile("schema.csv");
+    datamanagement::source::Schema schema = csv_source.GetSchema();
+    EXPECT_EQ(schema.delimiter, ';');
+    EXPECT_EQ(schema.header_row, 0);
+    EXPECT_EQ(schema.columns,
+              std::vector<std::string>({"id", "name", "score", "note"}));
+    EXPECT_EQ(schema.sampled_rows, 4);
+    EXPECT_EQ(schema.types[0], csv::DataType::CSV_INT8);
+    EXPECT_EQ(schema.types[1], csv::DataType::CSV_STRING);
+    EXPECT_EQ(schema.types[2], csv::DataType::CSV_DOUBLE);
+    EXPECT_EQ(schema.types[3], csv::DataType::CSV_STRING);
+
+    // Only complete rows in the probed prefix are sampled
+    schema = csv_source.GetSchema(32);
+    EXPECT_EQ(schema.columns.size(), 4);
+    EXPECT_EQ(schema.sampled_rows, 1);
+    EXPECT_EQ(schema.types[3], csv::DataType::CSV_NULL);
+
+    csv_source.ConnectToFile("missing.csv");
+    EXPECT_THROW(csv_source.GetSchema(), std::runtime_error);
+    std::remove("schema.csv");
+}
@@ -14,6 +14,7 @@
 // ----------	---	--------------------------------------------------------- //
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
@@ -124,3 +125,267 @@ TEST_F(DBSourceTest, BatchExecute) {
     EXPECT_EQ(results.size(), 13);
     EXPECT_EQ(std::get<1>(results[3]), "Test0");
 }
+
+TEST_F(DBSourceTest, GetSparseData) {
+    datamanagement::source::DBSource db_source;
+    db_source.ConnectToDatabase("test.db");
+
+    Eigen::SparseMatrix<double> data = db_source.GetSparseData(
+        "SELECT id, age - 30, NULL FROM test WHERE id >= ?;", {{1, 2}});
+    EXPECT_EQ(data.rows(), 2);
+    EXPECT_EQ(data.cols(), 3);
+    EXPECT_EQ(data.nonZeros(), 4);
+    EXPECT_EQ(data.coeff(0, 1), -5);
+    EXPECT_EQ(data.coeff(1, 1), 5);
+
+    Eigen::SparseMatrix<int> ages =
+        db_source.GetSparseData<int>("SELECT age FROM test;");
+    EXPECT_EQ(ages.coeff(2, 0), 35);
+    EXPECT_THROW(db_source.GetSparseData<int>("SELECT 2.5;"),
+                 std::runtime_error);
+    EXPECT_THROW(db_source.GetSparseData("SELECT name FROM test;"),
+                 std::runtime_error);
+}
+
+TEST_F(DBSourceTest, StatementCache) {
+    datamanagement::source::DBSource db_source;
+    db_source.ConnectToDatabase("test.db");
+    EXPECT_EQ(db_source.GetStatementCacheSize(),
+              datamanagement::source::DBSource::DEFAULT_STATEMENT_CACHE_SIZE);
+
+    const std::string query = "SELECT name FROM test WHERE id = ?;";
+    auto name_of = [&](int id) {
+        std::any storage = std::string();
+        db_source.Select(
+            query,
+            [](std::any &storage, const SQLite::Statement &stmt) {
+                storage = std::string(stmt.getColumn(0).getText());
+            },
+            storage, {{1, id}});
+        return std::any_cast<std::string>(storage);
+    };
+    EXPECT_EQ(name_of(1), "Alice");
+    EXPECT_EQ(name_of(3), "Charlie");
+    EXPECT_EQ(db_source.CachedStatements(), 1);
+
+    // A query issued while the same statement is stepping gets its own
+    const std::string ids = "SELECT id FROM test ORDER BY id;";
+    std::any counts = std::vector<Eigen::Index>{};
+    db_source.Select(
+        ids,
+        [&](std::any &storage, const SQLite::Statement &) {
+            std::any_cast<std::vector<Eigen::Index>>(&storage)->push_back(
+                db_source.GetSparseData(ids).nonZeros());
+        },
+        counts);
+    EXPECT_EQ(std::any_cast<std::vector<Eigen::Index>>(counts),
+              std::vector<Eigen::Index>({3, 3, 3}));
+    EXPECT_EQ(db_source.CachedStatements(), 2);
+
+    db_source.SetStatementCacheSize(1);
+    EXPECT_EQ(db_source.CachedStatements(), 1);
+    db_source.BatchExecute("UPDATE test SET age = ? WHERE id = ?;",
+                           {{{1, 31}, {2, 1}}});
+    EXPECT_EQ(db_source.CachedStatements(), 1);
+    Eigen::SparseMatrix<double> ages =
+        db_source.GetSparseData("SELECT age FROM test WHERE id = 1;");
+    EXPECT_EQ(ages.coeff(0, 0), 31);
+
+    db_source.SetStatementCacheSize(0);
+    EXPECT_EQ(name_of(2), "Bob");
+    EXPECT_EQ(db_source.CachedStatements(), 0);
+}
+
+TEST_F(DBSourceTest, SelectTyped) {
+    datamanagement::source::DBSource db_source;
+    db_source.ConnectToDatabase("test.db");
+    db_source.BatchExecute("INSERT INTO test (name) VALUES (?);",
+                           {{{1, std::string("Dana")}}});
+
+    std::vector<std::tuple<int, std::string, std::optional<double>>> rows =
+        db_source.Select<int, std::string, std::optional<double>>(
+            "SELECT id, name, age FROM test WHERE id > ? ORDER BY id;",
+            {{1, 1}});
+    ASSERT_EQ(rows.size(), 3);
+    EXPECT_EQ(rows[0], std::make_tuple(2, std::string("Bob"),
+                                       std::optional<double>(25)));
+    EXPECT_EQ(std::get<1>(rows[2]), "Dana");
+    EXPECT_FALSE(std::get<2>(rows[2]).has_value());
+
+    struct Person {
+        int64_t id = 0;
+        std::string name = "";
+    };
+    std::vector<Person> people = db_source.SelectInto<Person>(
+        "SELECT id, name FROM test ORDER BY id;", {}, &Person::id,
+        &Person::name);
+    ASSERT_EQ(people.size(), 4);
+    EXPECT_EQ(people[2].id, 3);
+    EXPECT_EQ(people[2].name, "Charlie");
+
+    EXPECT_THROW((db_source.Select<int, int>("SELECT id FROM test;")),
+                 std::runtime_error);
+}
+
+TEST_F(DBSourceTest, GetData) {
+    datamanagement::source::DBSource db_source;
+    db_source.ConnectToDatabase("test.db");
+
+    Eigen::MatrixXd data = db_source.GetData("test", {"id", "age"}, {});
+    Eigen::MatrixXd expected(3, 2);
+    expected << 1, 30, 2, 25, 3, 35;
+    EXPECT_EQ(data, expected);
+
+    Eigen::MatrixXd filtered =
+        db_source.GetData("test", {"age"}, {{"name", "Bob"}, {"id", "2"}});
+    ASSERT_EQ(filtered.rows(), 1);
+    EXPECT_EQ(filtered(0, 0), 25);
+
+    Eigen::MatrixXi ages = db_source.GetData<int>(
+        "SELECT age, NULL FROM test WHERE age > ? ORDER BY age;", {{1, 26}});
+    Eigen::MatrixXi expected_ages(2, 2);
+    expected_ages << 30, 0, 35, 0;
+    EXPECT_EQ(ages, expected_ages);
+    EXPECT_EQ(db_source.GetData<int>("SELECT 3.0;")(0, 0), 3);
+    EXPECT_THROW(db_source.GetData<int>("SELECT 2.5;"), std::runtime_error);
+    EXPECT_EQ(db_source.GetData("SELECT '4.5';")(0, 0), 4.5);
+    EXPECT_THROW(db_source.GetData("SELECT name FROM test;"),
+                 std::runtime_error);
+    EXPECT_THROW(db_source.GetData("SELECT '12abc';"), std::runtime_error);
+    EXPECT_THROW(db_source.GetData("SELECT x'01';"), std::runtime_error);
+
+    EXPECT_THROW(db_source.GetData("test", {"height"}, {}), std::runtime_error);
+}
+
+TEST_F(DBSourceTest, ExecuteTyped) {
+    datamanagement::source::DBSource db_source;
+    db_source.ConnectToDatabase("test.db");
+
+    std::string name = "Bob";
+    EXPECT_EQ(db_source.Execute("UPDATE test SET age = ? WHERE name = ?;", 26,
+                                name),
+              1);
+    EXPECT_EQ(db_source.Execute("INSERT INTO test (name, age) VALUES (?, ?);",
+                                "Dana", std::nullopt),
+              1);
+
+    std::vector<std::tuple<std::string, int64_t>> rows;
+    for (int i = 0; i < 100; ++i) {
+        rows.emplace_back("Row" + std::to_string(i), i);
+    }
+    db_source.BatchExecute("INSERT INTO test (name, age) VALUES (?, ?);",
+                           rows);
+
+    std::vector<std::string> names = {"Eve", "Frank"};
+    std::vector<std::optional<double>> ages = {41.0, std::nullopt};
+    db_source.BatchExecuteColumns(
+        "INSERT INTO test (name, age) VALUES (?, ?);", names, ages);
+
+    auto result = db_source.Select<std::string, std::optional<int>>(
+        "SELECT name, age FROM test WHERE id IN (2, 4, 54, 105, 106) "
+        "ORDER BY id;");
+    ASSERT_EQ(result.size(), 5);
+    EXPECT_EQ(result[0], std::make_tuple(std::string("Bob"),
+                                         std::optional<int>(26)));
+    EXPECT_EQ(result[1], std::make_tuple(std::string("Dana"),
+                                         std::optional<int>()));
+    EXPECT_EQ(result[2], std::make_tuple(std::string("Row49"),
+                                         std::optional<int>(49)));
+    EXPECT_EQ(result[3], std::make_tuple(std::string("Eve"),
+                                         std::optional<int>(41)));
+    EXPECT_EQ(std::get<1>(result[4]), std::nullopt);
+
+    std::vector<int> short_column = {1};
+    EXPECT_THROW(db_source.BatchExecuteColumns(
+                     "INSERT INTO test (name, age) VALUES (?, ?);", names,
+                     short_column),
+                 std::runtime_error);
+}
+
+TEST_F(DBSourceTest, BulkInsert) {
+    datamanagement::source::DBSource db_source;
+    db_source.ConnectToDatabase("test.db");
+    db_source.Execute("CREATE TABLE output (t INTEGER, stratum INTEGER, "
+                      "value REAL);");
+
+    // More rows than fit in one statement, committed in several steps
+    const Eigen::Index rows = 40000;
+    Eigen::MatrixXd data(rows, 3);
+    for (Eigen::Index r = 0; r < rows; ++r) {
+        data.row(r) << r / 100, r % 100, r * 0.5;
+    }
+    db_source.BulkInsert("output", {"t", "stratum", "value"}, data, 15000);
+    Eigen::MatrixXd stored =
+        db_source.GetData("SELECT t, stratum, value FROM output ORDER BY "
+                          "rowid;");
+    EXPECT_EQ(stored, data);
+
+    // Short tails are not cached, so the cache holds the full statement
+    // and the SELECT above
+    db_source.BulkInsert("output", {"value", "t", "stratum"},
+                         data.topRows(2));
+    EXPECT_EQ(db_source.CachedStatements(), 2);
+    EXPECT_EQ(db_source.GetData("SELECT count(*) FROM output;")(0, 0),
+              rows + 2);
+    EXPECT_EQ(db_source.GetData("SELECT t FROM output WHERE rowid = ?;",
+                                {{1, static_cast<int>(rows) + 2}})(0, 0),
+              1);
+
+    EXPECT_THROW(db_source.BulkInsert("output", {"t", "stratum"}, data),
+                 std::runtime_error);
+    EXPECT_THROW(db_source.BulkInsert("output", {"t", "stratum", "height"},
+                                      data),
+                 std::runtime_error);
+}
+
+// Throughput of the three ways to write a result matrix. Disabled by
+// default; run with --gtest_also_run_disabled_tests in a release build.
+TEST_F(DBSourceTest, DISABLED_BulkInsertThroughput) {
+    using datamanagement::source::BindingVariant;
+    const Eigen::Index rows = 2000000;
+    Eigen::MatrixXd data(rows, 4);
+    for (Eigen::Index r = 0; r < rows; ++r) {
+        data.row(r) << r / 1000, r % 1000, r % 7, r * 0.25;
+    }
+    const std::string insert = "INSERT INTO output VALUES (?, ?, ?, ?);";
+
+    for (const std::string mode : {"maps", "tuples", "bulk"}) {
+        std::remove("bulk.db");
+        datamanagement::source::DBSource db_source;
+        db_source.ConnectToDatabase("bulk.db");
+        db_source.Execute("CREATE TABLE output (t INTEGER, stratum INTEGER, "
+                          "state INTEGER, value REAL);");
+
+        auto start = std::chrono::steady_clock::now();
+        if (mode == "maps") {
+            std::vector<std::unordered_map<int, BindingVariant>> batch;
+            batch.reserve(rows);
+            for (Eigen::Index r = 0; r < rows; ++r) {
+                batch.push_back({{1, static_cast<int>(data(r, 0))},
+                                 {2, static_cast<int>(data(r, 1))},
+                                 {3, static_cast<int>(data(r, 2))},
+                                 {4, data(r, 3)}});
+            }
+            db_source.BatchExecute(insert, batch);
+        } else if (mode == "tuples") {
+            std::vector<std::tuple<double, double, double, double>> batch;
+            batch.reserve(rows);
+            for (Eigen::Index r = 0; r < rows; ++r) {
+                batch.emplace_back(data(r, 0), data(r, 1), data(r, 2),
+                                   data(r, 3));
+            }
+            db_source.BatchExecute(insert, batch);
+        } else {
+            db_source.BulkInsert("output", {"t", "stratum", "state", "value"},
+                                 data);
+        }
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cout << mode << ": " << rows / elapsed.count() / 1e6
+                  << " M rows/s" << std::endl;
+
+        EXPECT_EQ(db_source.GetData("SELECT count(*) FROM output;")(0, 0),
+                  rows);
+    }
+    std::remove("bulk.db");
+}
@@ -168,4 +168,80 @@ TEST_F(ModelDataTest, WriteCSV) {
     Eigen::MatrixXd data2 = csv_source2.GetData({"id", "age"}, {});
     ASSERT_TRUE(data2.isApprox(data1));
     std::remove("output.csv");
-}
\ No newline at end of file
+}
+
+TEST_F(ModelDataTest, JoinCSVSources) {
+    std::ofstream params("params.csv");
+    params << "age,group,rate\n";
+    params << "30,a,0.1\n";
+    params << "35,b,0.2\n";
+    params << "35,b,0.3\n";
+    params << "40,a,0.4\n";
+    params.close();
+
+    datamanagement::ModelData md("test.conf");
+    md.AddSource("test.csv");
+    md.AddSource("params.csv");
+
+    Eigen::MatrixXd data =
+        md.JoinCSVSources("test", "params", {"age"}, {"id"}, {"rate"});
+    Eigen::MatrixXd expected(3, 2);
+    expected << 1, 0.1, 3, 0.2, 3, 0.3;
+    ASSERT_EQ(data.rows(), 3);
+    EXPECT_TRUE(data.isApprox(expected));
+
+    // The probe side runs in slices, and the order stays the same
+    md.GetCSVSource("params").SetThreads(3);
+    Eigen::MatrixXd swapped =
+        md.JoinCSVSources("params", "test", {"age"}, {"rate"}, {"id"});
+    Eigen::MatrixXd swapped_expected(3, 2);
+    swapped_expected << 0.1, 1, 0.2, 3, 0.3, 3;
+    EXPECT_TRUE(swapped.isApprox(swapped_expected));
+
+    std::ofstream people("people.csv");
+    people << "group,age,weight\n";
+    people << "b,35,2\n";
+    people << "a,35,3\n";
+    people << "a,30,4\n";
+    people.close();
+    md.AddSource("people.csv");
+    Eigen::MatrixXd composite = md.JoinCSVSources(
+        "people", "params", {"group", "age"}, {"weight"}, {"rate"});
+    Eigen::MatrixXd composite_expected(3, 2);
+    composite_expected << 2, 0.2, 2, 0.3, 4, 0.1;
+    EXPECT_TRUE(composite.isApprox(composite_expected));
+
+    EXPECT_THROW(md.JoinCSVSources("test", "missing", {"age"}, {"id"}, {}),
+                 std::runtime_error);
+    EXPECT_THROW(md.JoinCSVSources("test", "params", {"name"}, {"id"}, {}),
+                 std::runtime_error);
+    std::remove("params.csv");
+    std::remove("people.csv");
+}
+
+TEST_F(ModelDataTest, Prefetch) {
+    datamanagement::ModelData md("test.conf");
+    md.SetPrefetch(true, 2);
+    EXPECT_TRUE(md.IsPrefetching());
+    md.AddSource("test.csv");
+
+    datamanagement::source::CSVSource &source = md.GetCSVSource("test");
+    EXPECT_TRUE(source.IsCaching());
+    EXPECT_TRUE(source.IsPrefetching());
+    source.AddIndex("name");
+
+    Eigen::MatrixXd data = source.GetData({"id", "age"}, {{"name", "Bob"}});
+    EXPECT_FALSE(source.IsPrefetching());
+    EXPECT_TRUE(source.GetTable().HasIndex("name"));
+    ASSERT_EQ(data.rows(), 1);
+    EXPECT_EQ(data(0, 1), 25);
+
+    md.SetPrefetch(false);
+    md.AddSource("missing.csv");
+    EXPECT_FALSE(md.GetCSVSource("missing").IsPrefetching());
+
+    md.SetPrefetch(true, 1);
+    md.AddSource("missing.csv");
+    EXPECT_THROW(md.GetCSVSource("missing").GetData({"id"}, {}),
+                 std::exception);
+}